@@ -0,0 +1,58 @@
+#include "sim_coefficients.h"
+#include <libxml/parser.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// converts a coefficients configuration between the XML and the binary format - the format of the input is
+// detected from its content, the output is binary if its name ends with .bin and XML otherwise
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        printf("Usage: %s <input> <output>\n", argv[0]);
+        printf("  converts a coefficients configuration, the output is binary (*.bin) or XML (any other name)\n");
+        return EXIT_FAILURE;
+    }
+
+    SimCoefficientsReader reader = SimCoefficientsReader_open(argv[1]);
+    if (reader == NULL)
+    {
+        printf("Error - cannot read %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    SimCoefficientsFormat format = SimCoefficients_getFormat(argv[2]);
+    SimCoefficientsWriter writer = SimCoefficientsWriter_create(argv[2], format);
+    if (writer == NULL)
+    {
+        printf("Error - cannot write %s\n", argv[2]);
+        SimCoefficientsReader_close(reader);
+        return EXIT_FAILURE;
+    }
+
+    SimCoefficientsEntry entry;
+    int count = 0;
+
+    while (SimCoefficientsReader_next(reader, &entry))
+    {
+        SimCoefficientsWriter_write(writer, &entry);
+        count++;
+    }
+
+    bool failed = SimCoefficientsReader_hasFailed(reader);
+    SimCoefficientsReader_close(reader);
+
+    if (!SimCoefficientsWriter_close(writer))
+    {
+        printf("Error - cannot write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    if (failed)
+        printf("Warning - %s is damaged, only the first %d data point(s) are converted\n", argv[1], count);
+
+    printf("%d data point(s) converted to %s (%s)\n", count, argv[2], (format == SIM_COEFFICIENTS_BINARY) ? "binary" : "XML");
+
+    xmlCleanupParser();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -1,701 +1,2089 @@
-#include "iec61850_server.h"
-#include "hal_thread.h"
-#include <signal.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <math.h>
-#include <float.h>
-
-#include <stdio.h>
-#include <libxml/parser.h>
-#include <libxml/tree.h>
-
-#include "static_model.h"
-
-extern IedModel iedModel;
-
-#ifndef REPORT_BUFFER_SIZE
-    #define REPORT_BUFFER_SIZE 200000
-#endif
-
-#ifndef IEC_61850_EDITION
-    #define IEC_61850_EDITION IEC_61850_EDITION_2
-#endif
-
-#ifndef MAX_MMS_CONNECTIONS
-    #define MAX_MMS_CONNECTIONS 10
-#endif
-
-#ifndef MAX_DATA_POINTS
-    #define MAX_DATA_POINTS 10000
-#endif
-  
-uint16_t dataPointsCount = MAX_DATA_POINTS;
-DataAttribute* dataPointsValues[MAX_DATA_POINTS];
-DataAttribute* dataPointsTimestamps[MAX_DATA_POINTS];
-DataAttribute* dataPointsQuality[MAX_DATA_POINTS];
-
-float A[MAX_DATA_POINTS], Ar[MAX_DATA_POINTS];
-float B[MAX_DATA_POINTS], Br[MAX_DATA_POINTS];
-float C[MAX_DATA_POINTS], Cr[MAX_DATA_POINTS];
-float D[MAX_DATA_POINTS], Dr[MAX_DATA_POINTS];
-
-static int running = 0;
-static IedServer iedServer = NULL;
-
-static uint64_t writeCounter = 0;
-static uint64_t readCounter = 0;
-
-char* auth_password = NULL;
-
-void sigint_handler(int signalId)
-{
-    running = 0;
-}
-
-static void connectionHandler(IedServer self, ClientConnection connection, bool connected, void* parameter)
-{
-    char* clientAddress = ClientConnection_getPeerAddress(connection);
-    int openConnections = IedServer_getNumberOfOpenConnections(self);
-
-    if (connected)
-    {
-        printf("Connection opened from %s - Total connections %d\n", clientAddress, openConnections);
-    }
-    else
-        printf("Connection closed from %s - Total connections %d\n", clientAddress, openConnections);
-}
-
-
-static bool clientAuthenticator(void* parameter, AcseAuthenticationParameter authParameter, void** securityToken)
-{
-    printf("Authenticating...\n");
-    switch (authParameter->mechanism)
-    {
-        case ACSE_AUTH_NONE:
-            printf("...using neither ACSE nor TLS authentication\n");
-
-        break;
-
-        case ACSE_AUTH_PASSWORD:
-            printf("...using ACSE password for client authentication\n");
-            if (authParameter->value.password.passwordLength == (int)strlen(auth_password)) 
-            {
-                if (memcmp(authParameter->value.password.octetString, auth_password, authParameter->value.password.passwordLength) == 0)
-                {
-                    *securityToken = (void*) auth_password;
-                    printf("...authenticated.\n");
-                    return true;
-                }
-            }
-            printf("...wrong password\n");
-        break;
-
-        case ACSE_AUTH_CERTIFICATE:
-            printf("...ACSE certificate for client authentication - NOT SUPPERTED YET\n");
-        break;
-
-        case ACSE_AUTH_TLS:
-            printf("...using TLS certificate for client authentication - NOT SUPPERTED YET\n");
-
-        break;
-    
-        default:
-            printf("...using unknown method for client authentication\n");
-        break;
-    }
-
-    // not authenticated
-    printf("...authentication failed.\n");
-	return false;
-}
-
-static MmsDataAccessError readAccessHandler(LogicalDevice* ld, LogicalNode* ln, DataObject* dataObject, FunctionalConstraint fc, ClientConnection connection, void* parameter)
-{
-    readCounter++;
-    return DATA_ACCESS_ERROR_SUCCESS;
-}
-
-// (fuzzy) simulation control replacement
-float sim(float v, float r) { return v * (1+r*(2.0*rand()/RAND_MAX-1.0)); }
-
-float simA(int i) { return sim(A[i], Ar[i]); }
-float simB(int i) { return sim(B[i], Br[i]); }
-float simC(int i) { return sim(C[i], Cr[i]); }
-float simD(int i) { return sim(D[i], Dr[i]); }
-//
-
-void loadCoefficients()
-{
-    xmlDoc *doc = NULL;
-    xmlNode *nodeRoot = NULL;
-
-    LIBXML_TEST_VERSION
-
-    doc = xmlReadFile("/config.xml", NULL, 0);
-
-    if (doc == NULL) return;
-
-    nodeRoot = xmlDocGetRootElement(doc);
-
-    for (xmlNode *nodeDataPoint = nodeRoot->children; nodeDataPoint; nodeDataPoint = nodeDataPoint->next) 
-    {
-        if (nodeDataPoint->type == XML_ELEMENT_NODE) 
-        {
-            int i = atoi(xmlGetProp(nodeDataPoint, "i"));
-            //printf("%s [%3d]  -  ", xmlGetProp(nodeDataPoint, "name"), i);
-
-            for (xmlNode *nodeCoefficient = nodeDataPoint->children; nodeCoefficient; nodeCoefficient = nodeCoefficient->next) {
-                if (nodeCoefficient->type == XML_ELEMENT_NODE) 
-                {
-                    //printf("  %s = %s ± %s\n", xmlGetProp(nodeCoefficient, "name"), xmlNodeGetContent(nodeCoefficient), xmlGetProp(nodeCoefficient, "randomness"));
-
-                    float X = atof(xmlNodeGetContent(nodeCoefficient));
-                    float Xr = atof(xmlGetProp(nodeCoefficient, "randomness"));
-
-                    if (!xmlStrcmp(xmlGetProp(nodeCoefficient, "name"), BAD_CAST "A"))
-                    {
-                        //printf("   A[%d] = %f ± %0.2f", i, X, Xr);
-                        A[i] = X;
-                        Ar[i] = Xr;
-                    }
-                    if (!xmlStrcmp(xmlGetProp(nodeCoefficient, "name"), BAD_CAST "B"))
-                    {
-                        //printf("   B[%d] = %f ± %0.2f", i, X, Xr);
-                        B[i] = X;
-                        Br[i] = Xr;
-                    }
-                    if (!xmlStrcmp(xmlGetProp(nodeCoefficient, "name"), BAD_CAST "C"))
-                    {
-                        //printf("   C[%d] = %f ± %0.2f", i, X, Xr);
-                        C[i] = X;
-                        Cr[i] = Xr;
-                    }
-                    if (!xmlStrcmp(xmlGetProp(nodeCoefficient, "name"), BAD_CAST "D"))
-                    {
-                        //printf("   D[%d] = %f ± %0.2f", i, X, Xr);
-                        D[i] = X;
-                        Dr[i] = Xr;
-                    }
-                }
-            }
-            //printf("\n");
-        }        
-    }
-
-    xmlFreeDoc(doc);
-    xmlCleanupParser();
-}
-
-void saveCoefficients()
-{
-    xmlDocPtr doc = NULL;
-    xmlNodePtr nodeRoot = NULL, nodeDataPoint = NULL, nodeCoefficient = NULL;  
-    char buff[256];
-
-    LIBXML_TEST_VERSION;
-
-    doc = xmlNewDoc(BAD_CAST "1.0");
-    nodeRoot = xmlNewNode(NULL, BAD_CAST "DataPointsCoefficients");
-    xmlDocSetRootElement(doc, nodeRoot);
-
-    for (int i = 0; i < dataPointsCount; i++) 
-    {
-        DataAttribute* dPV = dataPointsValues[i];
-
-        if ((IedModel *)(dPV->parent->parent->parent->parent) != &iedModel)
-            sprintf(buff, "%s.%s.%s.%s.%s", dPV->parent->parent->parent->parent->name, dPV->parent->parent->parent->name, dPV->parent->parent->name, dPV->parent->name, dPV->name);
-        else
-            sprintf(buff, "%s.%s.%s.%s", dPV->parent->parent->parent->name, dPV->parent->parent->name, dPV->parent->name, dPV->name);
-        
-        
-        nodeDataPoint = xmlNewChild(nodeRoot, NULL, BAD_CAST "DataPoint", NULL);
-        xmlNewProp(nodeDataPoint, BAD_CAST "name", BAD_CAST buff);      
-        sprintf(buff, "%d", i);xmlNewProp(nodeDataPoint, BAD_CAST "i", BAD_CAST buff);
-
-        if (dPV->type == IEC61850_BOOLEAN)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_BOOLEAN");
-        if (dPV->type == IEC61850_INT8)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_INT8");
-        if (dPV->type == IEC61850_INT16)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_INT16");
-        if (dPV->type == IEC61850_INT32)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_INT32");
-        if (dPV->type == IEC61850_INT64)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_INT64");
-        if (dPV->type == IEC61850_INT8U)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_INT8U");
-        if (dPV->type == IEC61850_INT16U)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_INT16U");
-        if (dPV->type == IEC61850_INT24U || dPV->type == IEC61850_INT32U)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_INT24/32U");
-        if (dPV->type == IEC61850_FLOAT32)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_FLOAT32");
-        if (dPV->type == IEC61850_FLOAT64)
-            xmlNewProp(nodeDataPoint, BAD_CAST "type", BAD_CAST "IEC61850_FLOAT64");
-
-        sprintf(buff, "%f", A[i]); 
-        nodeCoefficient = xmlNewChild(nodeDataPoint, NULL, BAD_CAST "Coefficient", BAD_CAST buff);
-        xmlNewProp(nodeCoefficient, BAD_CAST "name", BAD_CAST "A");
-        sprintf(buff, "%0.2f", Ar[i]);
-        xmlNewProp(nodeCoefficient, BAD_CAST "randomness", BAD_CAST buff);
-
-        sprintf(buff, "%f", B[i]); 
-        nodeCoefficient = xmlNewChild(nodeDataPoint, NULL, BAD_CAST "Coefficient", BAD_CAST buff);
-        xmlNewProp(nodeCoefficient, BAD_CAST "name", BAD_CAST "B");
-        sprintf(buff, "%0.2f", Br[i]);
-        xmlNewProp(nodeCoefficient, BAD_CAST "randomness", BAD_CAST buff);
-
-        sprintf(buff, "%f", C[i]); 
-        nodeCoefficient = xmlNewChild(nodeDataPoint, NULL, BAD_CAST "Coefficient", BAD_CAST buff);
-        xmlNewProp(nodeCoefficient, BAD_CAST "name", BAD_CAST "C");
-        sprintf(buff, "%0.2f", Cr[i]);
-        xmlNewProp(nodeCoefficient, BAD_CAST "randomness", BAD_CAST buff);
-
-        sprintf(buff, "%f", D[i]); 
-        nodeCoefficient = xmlNewChild(nodeDataPoint, NULL, BAD_CAST "Coefficient", BAD_CAST buff);
-        xmlNewProp(nodeCoefficient, BAD_CAST "name", BAD_CAST "D");
-        sprintf(buff, "%0.2f", Dr[i]);
-        xmlNewProp(nodeCoefficient, BAD_CAST "randomness", BAD_CAST buff);
-    }
-
-    xmlSaveFormatFileEnc("/config.xml", doc, "UTF-8", 1);
-    xmlFreeDoc(doc);
-    xmlCleanupParser();
-    xmlMemoryDump();
-}
-
-int main(int argc, char** argv)
-{
-    char* ied_name = (getenv("IED_NAME") == NULL) ? "IED" : getenv("IED_NAME");
-
-    int mms_port = (getenv("MMS_PORT") == NULL) ? 102 : atoi(getenv("MMS_PORT"));
-
-    auth_password = (getenv("AUTH_PASSWORD") == NULL) ? NULL : getenv("AUTH_PASSWORD");
-
-    bool log_modeling = (getenv("LOG_MODELING") != NULL) && (strcmp(getenv("LOG_MODELING"), "true") == 0);
-    bool log_simulation = (getenv("LOG_SIMULATION") != NULL) && (strcmp(getenv("LOG_SIMULATION"), "true") == 0);
-    int simulation_frequency = (getenv("SIMULATION_FREQUENCY") == NULL) ? 1 : atoi(getenv("SIMULATION_FREQUENCY"));    
-
-    int log_diagnostics_interval = (getenv("LOG_DIAGNOSTICS_INTERVAL") == NULL) ? 5 : atoi(getenv("LOG_DIAGNOSTICS_INTERVAL"));
-
-    if (argc > 1)
-        ied_name = argv[1];
-
-    if (argc > 2)
-        mms_port = atoi(argv[2]);
-
-    if (argc > 3)
-        auth_password = argv[3];
-
-    printf("Fuzzy IEC61850 Simulation server\n");
-
-    printf("   libIEC61850 version       : %s\n", LibIEC61850_getVersionString());
-    printf("   IED Name                  : %s\n", ied_name);
-    printf("   Port                      : %d\n", mms_port);
-    printf("   Maximum connections       : %d\n", MAX_MMS_CONNECTIONS);
-    printf("   Authentication (password) : %s\n", (auth_password==NULL)?"/":auth_password);
-    printf("   Modeling log              : %s\n", log_modeling?"true":"false");
-    printf("   Simulation log            : %s\n", log_simulation?"true":"false");
-    printf("   Simulation frequancy      : %d Hz\n", simulation_frequency);
-    printf("   Diagnostics interval      : %d min\n", log_diagnostics_interval );
-
-    printf("\n");
-
-    // Server configuration
-    IedServerConfig config = IedServerConfig_create();
-    IedServerConfig_setReportBufferSize(config, REPORT_BUFFER_SIZE);
-    IedServerConfig_setEdition(config, IEC_61850_EDITION_2);
-    IedServerConfig_setFileServiceBasePath(config, "./vmd-filestore/");
-    IedServerConfig_enableFileService(config, false);
-    IedServerConfig_enableDynamicDataSetService(config, true);
-    IedServerConfig_enableLogService(config, false);
-    IedServerConfig_setMaxMmsConnections(config, MAX_MMS_CONNECTIONS);
-    IedModel_setIedName(&iedModel, ied_name);
-
-    // New IEC 61850 server instance
-    iedServer = IedServer_createWithConfig(&iedModel, NULL, config);
-    IedServerConfig_destroy(config);
-    IedServer_setServerIdentity(iedServer, "sting GmbH", "Fuzzy IEC61850 Simulator", "1.1");
-    
-    // Authentication
-    if (auth_password != NULL)
-        IedServer_setAuthenticator(iedServer, clientAuthenticator, NULL);
-
-        /*
-        AcseAuthenticationParameter auth = calloc(1, sizeof(struct sAcseAuthenticationParameter));
-        auth->mechanism = ACSE_AUTH_PASSWORD;
-        auth->value.password.octetString = "testpw";
-        
-        IsoServer_setAuthenticationParameter(iedServer, auth);        
-        */
-
-    // Tracking connections
-    IedServer_setConnectionIndicationHandler(iedServer, (IedConnectionIndicationHandler) connectionHandler, NULL);
-
-    // Read access handler (only to count reads)
-    IedServer_setReadAccessHandler(iedServer, readAccessHandler, NULL);
-
-    // start server
-    printf("Starting server... ");
-    IedServer_start(iedServer, mms_port);
-    if (!IedServer_isRunning(iedServer)) {
-        printf("Failed! (maybe need root permissions or another server is already using the port)!\n");
-        IedServer_destroy(iedServer);
-        exit(-1);
-    }
-    printf("Done!\n\n");
-
-    running = 1;
-    signal(SIGINT, sigint_handler);
-
-    // init coefficients
-    dataPointsCount = 0;
-    for (int i=0; i<MAX_DATA_POINTS; i++)
-    {
-        A[i] = NAN; Ar[i] = NAN;
-        B[i] = NAN; Br[i] = NAN;
-        C[i] = NAN; Cr[i] = NAN;
-        D[i] = NAN; Dr[i] = NAN;
-    }
-    loadCoefficients();
-
-    // runtime prepare
-    printf("Browsing the model & preparing runtime... ");
-
-    if (log_modeling) printf("\n");
-
-    LogicalDevice* logicalDevice = iedModel.firstChild;
-    while (logicalDevice != NULL)
-    {
-        if (log_modeling) printf("Logical device - %s\n", logicalDevice->name);
-
-        // pre 
-
-        ModelNode * logicalDeviceChild = logicalDevice->firstChild;
-        while (logicalDeviceChild != NULL)
-        {
-            LogicalNode * logicalNode = (LogicalNode *)logicalDeviceChild;
-            if (logicalNode == NULL)
-            {
-                if (log_modeling) printf("  Logical node ??? %s / %d\n", logicalDeviceChild->name, logicalDeviceChild->modelType);
-                logicalDeviceChild = logicalDeviceChild->sibling;
-                continue;
-            }
-            if (log_modeling) printf("  Logical node - %s\n", logicalNode->name);
-
-
-            // pre 
-
-            ModelNode * logicalNodeChild = logicalNode->firstChild;
-            while (logicalNodeChild != NULL)
-            {
-                DataObject * dataObject = (DataObject *)logicalNodeChild;
-                if (dataObject == NULL)
-                {
-                    if (log_modeling) printf("    Data object ??? %s / %d\n", logicalNodeChild->name, logicalNodeChild->modelType);
-                    logicalNodeChild = logicalNodeChild->sibling;
-                    continue;
-                }
-                if (log_modeling) printf("    Data object - %s\n", dataObject->name);
-
-                // pre 
-                DataAttribute * dA_VAL = NULL;
-                DataAttribute * dA_TS = NULL;
-                DataAttribute * dA_Q = NULL;
-
-                // iterate
-                ModelNode * dataObjectChild = dataObject->firstChild;
-                while (dataObjectChild != NULL)
-                {
-                    if (dataObjectChild->modelType == DataObjectModelType)
-                    {
-                        DataObject * dO = (DataObject *)dataObjectChild;
-                        if (log_modeling) printf("      Data object - %s ???\n", dO->name);
-                        
-                        dataObjectChild = dataObjectChild->sibling;
-                        continue;
-                    }
-
-                    DataAttribute * dA = (DataAttribute *)dataObjectChild;
-                    if (dataObjectChild->modelType != DataAttributeModelType || dA == NULL)
-                    {
-                        if (log_modeling) printf("      ??? Model Type '%d' - %s\n", dataObjectChild->modelType, dataObjectChild->name);
-                        dataObjectChild = dataObjectChild->sibling;
-                        continue;
-                    }
-                    if (log_modeling) printf("      Data attribute - %s (#%d) %d", dA->name, dA->sAddr, dA->type);
-
-                    //////
-
-                    if (dA->type == IEC61850_CONSTRUCTED) if (log_modeling) printf(" /IEC61850_CONSTRUCTED");
-                    if (dA->type == IEC61850_TIMESTAMP) if (log_modeling) printf(" /IEC61850_TIMESTAMP");
-                    if (dA->type == IEC61850_QUALITY) if (log_modeling) printf(" /IEC61850_QUALITY");
-                    if (dA->triggerOptions & TRG_OPT_DATA_CHANGED) if (log_modeling) printf(" *TRG_OPT_DATA_CHANGED");
-                    if (dA->triggerOptions & TRG_OPT_DATA_UPDATE) if (log_modeling) printf(" *TRG_OPT_DATA_UPDATE");
-                    
-                    if (dA->type == IEC61850_TIMESTAMP)
-                    {
-                        dA_TS = dA;
-                        if (log_modeling) printf(" [IEC61850_TIMESTAMP]");
-                    }
-                    if (dA->type == IEC61850_QUALITY)
-                    {
-                        dA_Q = dA;
-                        if (log_modeling) printf(" [IEC61850_QUALITY]");
-                    }
-
-                    DataAttribute * dP = dA;
-                    if (dA->type == IEC61850_CONSTRUCTED)
-                    {
-                        dP = (DataAttribute * )(dP->firstChild);
-                        if (log_modeling) printf("\n        Data attribute - %s %d", dP->name, dP->type);
-                    }
-
-                    if ((dA->triggerOptions & TRG_OPT_DATA_CHANGED) || (dA->triggerOptions & TRG_OPT_DATA_UPDATE))
-                    {
-                        // default coeficients
-                        int i = dataPointsCount;
-
-                        if (dP->type == IEC61850_BOOLEAN)
-                        {
-                            if isnan(B[i]) { B[i] = 1.0f; Br[i] = 0.01f; }
-                            
-                            if (log_modeling) printf(" [IEC61850_BOOLEAN]");
-                            dA_VAL = dP;
-                        }
-                        if (dP->type == IEC61850_INT8)
-                        {
-                            if isnan(B[i]) { B[i] = 0.95f * INT8_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_INT8]");
-                            dA_VAL= dP;                            
-                        }
-                        if (dP->type == IEC61850_INT16)
-                        {
-                            if isnan(B[i]) { B[i] = 0.95f * INT16_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_INT16]");
-                            dA_VAL= dP;                            
-                        }
-                        if (dP->type == IEC61850_INT32)
-                        {
-                            if isnan(B[i]) { B[i] = 0.95f * INT32_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_INT32]");
-                            dA_VAL= dP;
-                        }
-                        if (dP->type == IEC61850_INT64)
-                        {       
-                            if isnan(B[i]) { B[i] = 0.95f * INT64_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_INT64]");
-                            int64_t z = 0;
-                            dA_VAL = dP;
-                        }
-                        if (dP->type == IEC61850_INT8U)
-                        {
-                            if isnan(A[i]) { A[i] = 0.5f * INT8_MAX; Br[i] = 0.00f; }
-                            if isnan(B[i]) { B[i] = 0.45f * INT8_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_INT8U]");
-                            uint8_t t = 0;
-                            dA_VAL = dP;
-                        }
-                        if (dP->type == IEC61850_INT16U)
-                        {
-                            if isnan(A[i]) { A[i] = 0.5f * INT16_MAX; Br[i] = 0.00f; }
-                            if isnan(B[i]) { B[i] = 0.45f * INT16_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_INT16U]");
-                            dA_VAL = dP;                            
-                        }
-                        if (dP->type == IEC61850_INT24U ||
-                            dP->type == IEC61850_INT32U)
-                        {
-                            if isnan(A[i]) { A[i] = 0.5f * INT32_MAX; Br[i] = 0.00f; }
-                            if isnan(B[i]) { B[i] = 0.45f * INT32_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_INT24/32U]");
-                            dA_VAL= dP;
-                        }
-                        if (dP->type == IEC61850_FLOAT32)
-                        {
-                            if isnan(B[i]) { B[i] = 0.95f * FLT_MAX; Br[i] = 0.05f; }
-
-                            if (log_modeling) printf(" [IEC61850_FLOAT32]");
-                            dA_VAL = dP;
-                        }
-                        if (dP->type == IEC61850_FLOAT64)
-                        {
-                            if isnan(B[i]) { B[i] = 0.95f * DBL_MAX; Br[i] = 0.05f;}
-
-                            if (log_modeling) printf(" [IEC61850_FLOAT64]");
-                            dA_VAL = dP;
-                        }
-                        
-                        if isnan(A[i]) { A[i] = 0.0f; Ar[i] = 0.01f; }
-                        if isnan(B[i]) { B[i] = 1.0f; Br[i] = 0.01f; }
-                        if isnan(C[i]) { C[i] = sim(1,0.8); Cr[i] = 0.01f; }          // time 0.2..1.8 randomness 1%
-                        if isnan(D[i]) { D[i] = sim(M_PI, 1.0); Dr[i] = 0.1f; }       // phase 0..2*PI randomness 10%
-
-                        if (log_modeling) printf("   A: %f ± %0.0f%%   B: %f ± %0.0f%%   C: %f ± %0.0f%%   D: %f ± %0.0f%%", A[i], 100*Ar[i], B[i], 100*Br[i], C[i], 100*Cr[i], D[i], 100*Dr[i] );
-                    }
-                                       
-                    if (log_modeling) printf("\n");
-                    /////
-
-                    dataObjectChild = dataObjectChild->sibling;
-                }
-
-                // post
-                if (dA_TS != NULL && dA_VAL != NULL)
-                {
-                    dataPointsValues[dataPointsCount] = dA_VAL;
-                    dataPointsTimestamps[dataPointsCount] = dA_TS;
-                    dataPointsQuality[dataPointsCount] = dA_Q;
-                    dataPointsCount++;
-                    if (log_modeling) printf("      --- %d  ---\n", dataPointsCount);
-
-                    if (dataPointsCount == MAX_DATA_POINTS)
-                    {
-                        printf("Error - Maximum number (%d) of data points reached. Increase parameter MAX_DATA_POINTS. Terminating...", MAX_DATA_POINTS);
-                        exit(EXIT_FAILURE);
-                    }
-                }                
-                logicalNodeChild = logicalNodeChild->sibling;
-            }
-
-            // post
-
-            logicalDeviceChild = logicalDeviceChild->sibling;
-        }
-
-        // post
-
-        logicalDevice = (LogicalDevice *)(logicalDevice->sibling);
-    }
-    printf("Done!\n\n");
-    
-    saveCoefficients();
-
-    // runtime
-    printf("Starting simulation...\n");
-
-    float t = 0.f;
-    srandom(Hal_getTimeInMs());
-
-    uint64_t timestamp_ = Hal_getTimeInMs();
-
-    while (running) {
-        uint64_t timestamp = Hal_getTimeInMs();
-
-        t += 1.0f / simulation_frequency;
-
-        Timestamp iecTimestamp;
-        Timestamp_clearFlags(&iecTimestamp);
-        Timestamp_setTimeInMilliseconds(&iecTimestamp, timestamp);
-        Timestamp_setLeapSecondKnown(&iecTimestamp, true);
-
-        Quality iecQuality = QUALITY_VALIDITY_GOOD;
-
-        /* toggle clock-not-synchronized flag in timestamp */
-        if (((int) t % 2) == 0)
-            Timestamp_setClockNotSynchronized(&iecTimestamp, true);
-
-        IedServer_lockDataModel(iedServer);
-
-        int i = random() * dataPointsCount / RAND_MAX;
-
-        DataAttribute* dPT = dataPointsTimestamps[i];
-        DataAttribute* dPV = dataPointsValues[i];
-        DataAttribute* dPQ = dataPointsQuality[i];
-
-        if (dPT == NULL || dPV == NULL) continue;
-        
-        if (log_simulation)
-        {
-            if ((IedModel *)(dPV->parent->parent->parent->parent) != &iedModel)
-                printf("%s.", dPV->parent->parent->parent->parent->name);
-            printf("%s.%s.%s.", dPV->parent->parent->parent->name, dPV->parent->parent->name, dPV->parent->name);
-        }
-
-        float simVal = simA(i) + simB(i) * sinf( simC(i) * t + simD(i));
-        
-        if (dPV->type == IEC61850_FLOAT32 ||
-            dPV->type == IEC61850_FLOAT64)
-        {
-            float val = simVal;
-            if (log_simulation) printf("%s [FLOAT] <- %f\n", dPV->name, val);
-            IedServer_updateTimestampAttributeValue(iedServer, dPT, &iecTimestamp);
-            IedServer_updateQuality(iedServer, dPQ, iecQuality);
-            IedServer_updateFloatAttributeValue(iedServer, dPV, val);
-            writeCounter++;
-        } else
-        if (dPV->type == IEC61850_INT8 ||
-            dPV->type == IEC61850_INT16 ||
-            dPV->type == IEC61850_INT32)
-        {
-            int32_t val = simVal;
-            if (log_simulation) printf("%s [INT]  <- %d\n", dPV->name, val);
-            IedServer_updateTimestampAttributeValue(iedServer, dPT, &iecTimestamp);
-            IedServer_updateQuality(iedServer, dPQ, iecQuality);
-            IedServer_updateInt32AttributeValue(iedServer, dPV, val);
-            writeCounter++;
-        } else
-        if (dPV->type == IEC61850_INT64)
-        {
-            int64_t val = simVal;
-            if (log_simulation) printf("%s [LONG] <- %ld\n", dPV->name, val);
-            IedServer_updateTimestampAttributeValue(iedServer, dPT, &iecTimestamp);
-            IedServer_updateQuality(iedServer, dPQ, iecQuality);
-            IedServer_updateFloatAttributeValue(iedServer, dPV, val);
-            writeCounter++;
-        } else            
-        if (dPV->type == IEC61850_INT8U ||
-            dPV->type == IEC61850_INT16U ||
-            dPV->type == IEC61850_INT24U ||
-            dPV->type == IEC61850_INT32U)
-        {
-            uint32_t val = abs(simVal);
-            if (log_simulation) printf("%s [UINT] <- %d\n", dPV->name, val);
-            IedServer_updateTimestampAttributeValue(iedServer, dPT, &iecTimestamp);
-            IedServer_updateQuality(iedServer, dPQ, iecQuality);
-            IedServer_updateUnsignedAttributeValue(iedServer, dPV, val);
-            writeCounter++;
-        } else
-        if (dPV->type == IEC61850_BOOLEAN)
-        {
-            bool val = simVal >= 0.0f;
-            if (log_simulation) printf("%s [BOOL] <- %s\n", dPV->name, val ? "true" : "false");
-            IedServer_updateTimestampAttributeValue(iedServer, dPT, &iecTimestamp);
-            IedServer_updateQuality(iedServer, dPQ, iecQuality);
-            IedServer_updateBooleanAttributeValue(iedServer, dPV, val);
-            writeCounter++;
-        }
-
-        IedServer_unlockDataModel(iedServer);
-
-
-        if (((timestamp/1000) % (60 * log_diagnostics_interval)) == 0 && timestamp-timestamp_ > 1000) // every 15 minutes
-        {
-            printf(" [%ld] total simulated / read (last %d s) - %.1f/s / %.1f/s\n", timestamp / 1000, (int)(timestamp-timestamp_) / 1000, 1000.0f * writeCounter / (timestamp-timestamp_), 1000.0f * readCounter / (timestamp-timestamp_));
-            timestamp_ = timestamp;
-            writeCounter = 0;
-            readCounter = 0;
-        }
-
-        //uint64_t sleeptime = Hal_getTimeInMs() - timestamp + 1000.0f / simulation_frequency;
-        //Thread_sleep(sleeptime);
-
-        Thread_sleep(1000.0f / simulation_frequency);
-    }
-
-    printf("Stopped!\n\n");
-
-    // stop server, close TCP server and client sockers
-    IedServer_stop(iedServer);
-
-    // cleanup / free resources
-    IedServer_destroy(iedServer);
-}
+#include "iec61850_server.h"
+#include "hal_thread.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+
+#include <stdio.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+#include "sim_scheduler.h"
+#include "sim_kernel.h"
+#include "sim_wheel.h"
+#include "sim_random.h"
+#include "sim_workers.h"
+#include "sim_model.h"
+#include "sim_visitor.h"
+#include "sim_index.h"
+#include "sim_coefficients.h"
+#include "sim_watcher.h"
+#include "sim_reports.h"
+#include "sim_buffers.h"
+#include "sim_goose.h"
+#include "sim_sv.h"
+
+#ifndef REPORT_BUFFER_SIZE
+    #define REPORT_BUFFER_SIZE 200000
+#endif
+
+#ifndef IEC_61850_EDITION
+    #define IEC_61850_EDITION IEC_61850_EDITION_2
+#endif
+
+#ifndef MAX_MMS_CONNECTIONS
+    #define MAX_MMS_CONNECTIONS 10
+#endif
+
+// data point table - structure of arrays sized from the model, each array aligned to the cache line
+int dataPointsCount = 0;
+static uint32_t dataPointsCapacity = 0;
+static size_t dataPointsRowSize = 0;            // bytes per data point, all columns
+DataAttribute** dataPointsValues = NULL;
+int32_t* dataPointsElement = NULL;              // element of an array value, -1 - not an array
+DataAttribute** dataPointsTimestamps = NULL;
+DataAttribute** dataPointsQuality = NULL;
+uint32_t* dataPointsPeriod = NULL;              // update period [ms], 0 - not scheduled individually
+float* dataPointsDeadband = NULL;               // absolute deadband, NAN - default
+float* dataPointsDeadbandRel = NULL;            // relative deadband (fraction of the last reported value), NAN - default
+uint32_t* dataPointsDevice = NULL;              // index of the logical device (unique across instances)
+uint32_t* dataPointsInstance = NULL;            // index of the IED instance
+
+float *A = NULL, *Ar = NULL;
+float *B = NULL, *Br = NULL;
+float *C = NULL, *Cr = NULL;
+float *D = NULL, *Dr = NULL;
+
+// per tick - coefficient salt and evaluated simulation values
+static float *noiseA = NULL, *noiseB = NULL;
+static float *noiseC = NULL, *noiseD = NULL;
+static float* simValues = NULL;
+
+static int running = 0;
+
+// simulated IEDs - each one has its own model and server, and owns a contiguous range [first, end) of the data points
+typedef struct
+{
+    char name[65];
+    char model[256];            // SCL file (ICD, CID, IID, SCD) or model configuration file (.cfg)
+    char ied[65];               // IED of an SCD file, empty - the first one
+    char config[256];           // coefficients configuration file, empty - none
+    char ip[64];                // local IP address, empty - any
+    int port;
+    int frequency;              // update frequency of the data points [Hz], 0 - simulation default
+    int brcbBufferSize;         // report buffer size of each BRCB / URCB [bytes], 0 - default
+    int urcbBufferSize;
+
+    IedModel* iedModel;
+    SimModelTemplate modelTemplate;
+    IedServer iedServer;
+
+    int first;
+    int end;
+    SimIndex index;             // object reference -> data point
+    uint64_t referencesKey;     // of the object references of the data points, in order
+    bool configCurrent;         // binary configuration copied as a whole, nothing to regenerate
+    SimReports reports;         // generated data sets and report control blocks, NULL - none
+    SimBuffers buffers;         // estimated occupancy of the report buffers, NULL - no control blocks
+} SimInstance;
+
+// coefficients of the simulation function of all data points - the table columns are the active set; a reload fills
+// the spare set (from a copy of the active one) and hands it over as pending, the simulation exchanges the columns
+// between two ticks and returns the replaced ones as the new spare set
+typedef struct
+{
+    float* X[4];                // A, B, C, D
+    float* Xr[4];
+    float* deadband;
+    float* deadbandRelative;
+    uint32_t* period;           // NULL - not reloaded (the schedule is built at the start)
+} CoefficientSet;
+
+static CoefficientSet reloadSet;
+static CoefficientSet* spareCoefficients = NULL;        // owned by the reload, NULL - handed over
+static CoefficientSet* pendingCoefficients = NULL;      // ready to be swapped in
+
+#define MAX_INSTANCES 1024
+
+static SimInstance* instances = NULL;
+static int instancesCount = 0;
+
+// model templates, one per model file of the manifest
+static SimModelTemplate modelTemplates[MAX_INSTANCES];
+static int modelTemplatesCount = 0;
+
+// binary model cache directory (NULL - disabled)
+static const char* modelCacheDirectory = NULL;
+
+// data sets and report control blocks generated for the instances
+static SimReportsConfig reportsConfig = { SIM_REPORTS_NONE, 100, true, true, 1, 100, 0 };
+
+// history the report buffer of a BRCB should hold [s] (for the estimated occupancy and the suggested sizes)
+static uint32_t reportBufferRetention = 60;
+
+static uint64_t writeCounter = 0;
+static uint64_t readCounter = 0;
+
+// change filter - updates within the deadband of the last reported value are not pushed into the model
+static bool filterUnchanged = false;
+static float defaultDeadband = 0.0f;
+static float defaultDeadbandRel = 0.0f;
+static double* dataPointsReported = NULL;
+static bool* dataPointsReportedValid = NULL;
+
+// new column of the data point table with the rows of the old one, new rows filled with NAN or zero
+static void* resizeColumn(void* column, size_t size, uint32_t capacity, bool fillNan)
+{
+    void* resized = NULL;
+
+    if (posix_memalign(&resized, SIM_KERNEL_ALIGNMENT, (size_t) capacity * size) != 0)
+        return NULL;
+
+    uint32_t kept = (dataPointsCapacity < capacity) ? dataPointsCapacity : capacity;
+    if (column != NULL)
+        memcpy(resized, column, (size_t) kept * size);
+
+    if (fillNan)
+        for (uint32_t i = kept; i < capacity; i++) ((float*) resized)[i] = NAN;
+    else
+        memset((char*) resized + (size_t) kept * size, 0, (size_t) (capacity - kept) * size);
+
+    free(column);
+    return resized;
+}
+
+#define RESIZE_COLUMN(column, fillNan) \
+    { \
+        void* resized = resizeColumn(column, sizeof(*(column)), capacity, fillNan); \
+        if (resized == NULL) \
+        { \
+            /* rows valid in all columns */ \
+            if (capacity < dataPointsCapacity) dataPointsCapacity = capacity; \
+            return false; \
+        } \
+        column = resized; \
+        rowSize += sizeof(*(column)); \
+    }
+
+// capacity rounded up to whole cache lines of the float columns
+static bool resizeDataPoints(uint32_t capacity)
+{
+    capacity = (capacity + 15) & ~(uint32_t) 15;
+    if (capacity == 0) capacity = 16;
+
+    size_t rowSize = 0;
+
+    RESIZE_COLUMN(dataPointsValues, false);
+    RESIZE_COLUMN(dataPointsElement, false);
+    RESIZE_COLUMN(dataPointsTimestamps, false);
+    RESIZE_COLUMN(dataPointsQuality, false);
+    RESIZE_COLUMN(dataPointsPeriod, false);
+    RESIZE_COLUMN(dataPointsDeadband, true);
+    RESIZE_COLUMN(dataPointsDeadbandRel, true);
+    RESIZE_COLUMN(dataPointsDevice, false);
+    RESIZE_COLUMN(dataPointsInstance, false);
+    RESIZE_COLUMN(dataPointsReported, false);
+    RESIZE_COLUMN(dataPointsReportedValid, false);
+    RESIZE_COLUMN(A, true); RESIZE_COLUMN(Ar, true);
+    RESIZE_COLUMN(B, true); RESIZE_COLUMN(Br, true);
+    RESIZE_COLUMN(C, true); RESIZE_COLUMN(Cr, true);
+    RESIZE_COLUMN(D, true); RESIZE_COLUMN(Dr, true);
+    RESIZE_COLUMN(noiseA, false); RESIZE_COLUMN(noiseB, false);
+    RESIZE_COLUMN(noiseC, false); RESIZE_COLUMN(noiseD, false);
+    RESIZE_COLUMN(simValues, false);
+
+    dataPointsCapacity = capacity;
+    dataPointsRowSize = rowSize;
+    return true;
+}
+
+// grows the table (doubling) to hold at least count data points
+static bool reserveDataPoints(uint32_t count)
+{
+    if (count <= dataPointsCapacity) return true;
+
+    uint32_t capacity = (dataPointsCapacity < 1024) ? 1024 : dataPointsCapacity;
+    while (capacity < count && capacity <= UINT32_MAX / 2) capacity *= 2;
+
+    return resizeDataPoints((capacity < count) ? count : capacity);
+}
+
+// update periods by logical node class (i.e. "MMXU=100,XCBR=10000,*=1000")
+#define MAX_RATE_CLASSES 64
+
+static struct { char lnClass[8]; uint32_t period; } rateClasses[MAX_RATE_CLASSES];
+static int rateClassesCount = 0;
+
+// deterministic replay - noise and point selection keyed by (seed, tick, point) instead of drawn from a stream
+static bool deterministic = false;
+static uint64_t deterministicSeed = 0;
+
+// values computed outside of the data model lock, waiting for the commit phase
+typedef enum { STAGED_FLOAT, STAGED_INT32, STAGED_INT64, STAGED_UINT32, STAGED_BOOLEAN } StagedKind;
+
+typedef struct
+{
+    int point;
+    StagedKind kind;
+    union { float f; int32_t i; int64_t l; uint32_t u; bool b; } value;
+    float simulated;
+} StagedUpdate;
+
+// simulation workers - each one owns a contiguous partition [first, end) of the data points
+typedef struct
+{
+    int first;
+    int end;
+
+    SimWheel wheel;             // scheduled mode - over the points of the partition, relative to first
+    int* duePoints;
+    int batchCursor;            // batch mode
+    double batchBudget;
+    uint64_t* pickedTick;       // deterministic legacy mode - tick + 1 a point was last picked in, relative to first
+
+    StagedUpdate* staged;
+    int stagedCount;
+
+    // statistics (since last report)
+    uint64_t updates;
+    uint64_t suppressed;
+    uint64_t busyNs;
+} SimPartition;
+
+static SimPartition* partitions = NULL;
+static int partitionsCount = 0;
+
+typedef enum { SIM_MODE_LEGACY, SIM_MODE_BATCH, SIM_MODE_SCHEDULED } SimMode;
+
+// current tick, shared with the workers
+static struct { SimMode mode; uint64_t tick; double t; int batch; int cursor; int frequency; uint64_t defaultPeriod; bool log; } tickJob;
+
+// data model lock - time waiting for it and time holding it [ns] (since last report)
+static struct { uint64_t count; uint64_t waitSum; uint64_t holdSum; uint64_t holdMax; } lockStatistics;
+
+// trace of the values pushed into the model (offset from start [ns], point, simulated value)
+static FILE* traceFile = NULL;
+static uint64_t traceOffsetNs = 0;
+
+char* auth_password = NULL;
+
+void sigint_handler(int signalId)
+{
+    running = 0;
+}
+
+static void connectionHandler(IedServer self, ClientConnection connection, bool connected, void* parameter)
+{
+    SimInstance* instance = (SimInstance*) parameter;
+    char* clientAddress = ClientConnection_getPeerAddress(connection);
+    int openConnections = IedServer_getNumberOfOpenConnections(self);
+
+    if (connected)
+    {
+        printf("%s - Connection opened from %s - Total connections %d\n", instance->name, clientAddress, openConnections);
+    }
+    else
+        printf("%s - Connection closed from %s - Total connections %d\n", instance->name, clientAddress, openConnections);
+}
+
+
+static bool clientAuthenticator(void* parameter, AcseAuthenticationParameter authParameter, void** securityToken)
+{
+    printf("Authenticating...\n");
+    switch (authParameter->mechanism)
+    {
+        case ACSE_AUTH_NONE:
+            printf("...using neither ACSE nor TLS authentication\n");
+
+        break;
+
+        case ACSE_AUTH_PASSWORD:
+            printf("...using ACSE password for client authentication\n");
+            if (authParameter->value.password.passwordLength == (int)strlen(auth_password)) 
+            {
+                if (memcmp(authParameter->value.password.octetString, auth_password, authParameter->value.password.passwordLength) == 0)
+                {
+                    *securityToken = (void*) auth_password;
+                    printf("...authenticated.\n");
+                    return true;
+                }
+            }
+            printf("...wrong password\n");
+        break;
+
+        case ACSE_AUTH_CERTIFICATE:
+            printf("...ACSE certificate for client authentication - NOT SUPPERTED YET\n");
+        break;
+
+        case ACSE_AUTH_TLS:
+            printf("...using TLS certificate for client authentication - NOT SUPPERTED YET\n");
+
+        break;
+    
+        default:
+            printf("...using unknown method for client authentication\n");
+        break;
+    }
+
+    // not authenticated
+    printf("...authentication failed.\n");
+	return false;
+}
+
+static MmsDataAccessError readAccessHandler(LogicalDevice* ld, LogicalNode* ln, DataObject* dataObject, FunctionalConstraint fc, ClientConnection connection, void* parameter)
+{
+    __atomic_fetch_add(&readCounter, 1, __ATOMIC_RELAXED);
+    return DATA_ACCESS_ERROR_SUCCESS;
+}
+
+// threadless servers - network I/O and periodic tasks of the servers, run by the scheduler between the ticks
+static void serverIdleHandler(void* parameter, uint32_t timeoutMs)
+{
+    if (instancesCount == 1)
+    {
+        if (IedServer_waitReady(instances[0].iedServer, timeoutMs) > 0)
+            IedServer_processIncomingData(instances[0].iedServer);
+
+        IedServer_performPeriodicTasks(instances[0].iedServer);
+        return;
+    }
+
+    // several servers - poll them all, then sleep for at most a millisecond
+    for (int k = 0; k < instancesCount; k++)
+    {
+        if (IedServer_waitReady(instances[k].iedServer, 0) > 0)
+            IedServer_processIncomingData(instances[k].iedServer);
+
+        IedServer_performPeriodicTasks(instances[k].iedServer);
+    }
+
+    if (timeoutMs > 0)
+        Thread_sleep(1);
+}
+
+// (fuzzy) simulation control replacement
+float sim(float v, float r) { return v * (1+r*SimRandom_uniform(SimRandom_thread(), -1.0f, 1.0f)); }
+
+//
+
+// evaluates data points [first, first + count) into simValues
+static void evaluateDataPoints(int first, int count, double t, uint64_t tick)
+{
+    if (deterministic)
+    {
+        SimRandom_fillUniformKeyed(deterministicSeed, tick, (0ULL << 32) + first, noiseA + first, count, -1.0f, 1.0f);
+        SimRandom_fillUniformKeyed(deterministicSeed, tick, (1ULL << 32) + first, noiseB + first, count, -1.0f, 1.0f);
+        SimRandom_fillUniformKeyed(deterministicSeed, tick, (2ULL << 32) + first, noiseC + first, count, -1.0f, 1.0f);
+        SimRandom_fillUniformKeyed(deterministicSeed, tick, (3ULL << 32) + first, noiseD + first, count, -1.0f, 1.0f);
+    }
+    else
+    {
+        SimRandom* rng = SimRandom_thread();
+
+        SimRandom_fillUniform(rng, noiseA + first, count, -1.0f, 1.0f);
+        SimRandom_fillUniform(rng, noiseB + first, count, -1.0f, 1.0f);
+        SimRandom_fillUniform(rng, noiseC + first, count, -1.0f, 1.0f);
+        SimRandom_fillUniform(rng, noiseD + first, count, -1.0f, 1.0f);
+    }
+
+    SimKernelInput input = {
+        A + first, Ar + first, B + first, Br + first,
+        C + first, Cr + first, D + first, Dr + first,
+        noiseA + first, noiseB + first, noiseC + first, noiseD + first
+    };
+
+    SimKernel_evaluate(&input, t, simValues + first, count);
+}
+
+void parseRateClasses(const char* spec)
+{
+    char* copy = strdup(spec);
+    char* saveptr = NULL;
+
+    for (char* entry = strtok_r(copy, ",; ", &saveptr); entry != NULL && rateClassesCount < MAX_RATE_CLASSES; entry = strtok_r(NULL, ",; ", &saveptr))
+    {
+        char* eq = strchr(entry, '=');
+        if (eq == NULL || eq == entry || eq - entry >= (int) sizeof(rateClasses[0].lnClass)) continue;
+
+        *eq = 0;
+        strcpy(rateClasses[rateClassesCount].lnClass, entry);
+        rateClasses[rateClassesCount].period = atoi(eq + 1);
+        rateClassesCount++;
+    }
+
+    free(copy);
+}
+
+// period [ms] for a logical node by its class (prefix + CLASS + instance, i.e. EXP6_GGIO2 -> GGIO)
+uint32_t lookupRateClass(const char* lnName)
+{
+    char lnClass[8];
+    int end = strlen(lnName);
+    while (end > 0 && lnName[end - 1] >= '0' && lnName[end - 1] <= '9') end--;
+    int start = (end >= 4) ? end - 4 : 0;
+    snprintf(lnClass, sizeof(lnClass), "%.*s", end - start, lnName + start);
+
+    uint32_t fallback = 0;
+    for (int c = 0; c < rateClassesCount; c++)
+    {
+        if (strcmp(rateClasses[c].lnClass, lnClass) == 0)
+            return rateClasses[c].period;
+        if (strcmp(rateClasses[c].lnClass, "*") == 0)
+            fallback = rateClasses[c].period;
+    }
+    return fallback;
+}
+
+// dotted path of a model node from its logical device (i.e. "LD0.MMXU1.PhV.phsA.cVal.mag.f")
+static char* modelNodePath(ModelNode* node, char* buffer, size_t size)
+{
+    ModelNode* path[32];
+    int depth = 0;
+
+    for (; node != NULL && depth < 32; node = node->parent)
+    {
+        path[depth++] = node;
+        if (node->modelType == LogicalDeviceModelType) break;
+    }
+
+    int length = 0;
+    buffer[0] = 0;
+    while (depth > 0 && length < (int) size)
+    {
+        depth--;
+        length += snprintf(buffer + length, size - length, "%s%s", (length > 0) ? "." : "", path[depth]->name);
+    }
+
+    return buffer;
+}
+
+// reference of a data point - path of its value, with the index of an array element
+static char* dataPointReference(int i, char* buffer, size_t size)
+{
+    modelNodePath((ModelNode*) dataPointsValues[i], buffer, size);
+
+    size_t length = strlen(buffer);
+    if (dataPointsElement[i] >= 0 && length < size)
+        snprintf(buffer + length, size - length, "[%d]", dataPointsElement[i]);
+
+    return buffer;
+}
+
+// coefficients of a data point from an entry of the configuration, what it does not set is left as it is
+static void applyCoefficients(CoefficientSet* set, int i, const SimCoefficientsEntry* entry)
+{
+    if (entry->period > 0 && set->period != NULL) set->period[i] = entry->period;
+    if (!isnan(entry->deadband)) set->deadband[i] = entry->deadband;
+    if (!isnan(entry->deadbandRelative)) set->deadbandRelative[i] = entry->deadbandRelative;
+
+    for (int c = 0; c < 4; c++)
+    {
+        if (!isnan(entry->X[c])) set->X[c][i] = entry->X[c];
+        if (!isnan(entry->Xr[c])) set->Xr[c][i] = entry->Xr[c];
+    }
+}
+
+// a column as a whole up to the first value that is not set (NaN, a missing coefficient), which keeps the default
+static void copyColumn(float* destination, const float* source, int count)
+{
+    int n = 0;
+
+    while (n < count && !isnan(source[n])) n++;
+
+    memcpy(destination, source, n * sizeof(float));
+
+    for (; n < count; n++)
+        if (!isnan(source[n])) destination[n] = source[n];
+}
+
+// binary configuration of exactly the data points of the instance - the columns are copied (almost) as a whole
+static void copyCoefficients(CoefficientSet* set, SimInstance* instance, const SimCoefficientsColumns* columns)
+{
+    int first = instance->first;
+
+    for (int c = 0; c < 4; c++)
+    {
+        copyColumn(set->X[c] + first, columns->X[c], columns->count);
+        copyColumn(set->Xr[c] + first, columns->Xr[c], columns->count);
+    }
+
+    for (int n = 0; n < columns->count; n++)
+    {
+        if (columns->period[n] > 0 && set->period != NULL) set->period[first + n] = columns->period[n];
+        if (!isnan(columns->deadband[n])) set->deadband[first + n] = columns->deadband[n];
+        if (!isnan(columns->deadbandRelative[n])) set->deadbandRelative[first + n] = columns->deadbandRelative[n];
+    }
+}
+
+// coefficients of the data points of an instance into a set, matched by object reference (after the model is browsed);
+// the configuration is XML or binary, by its content; false - it can not be read or is damaged
+bool loadCoefficients(SimInstance* instance, CoefficientSet* set)
+{
+    if (instance->config[0] == 0) return false;
+
+    SimCoefficientsReader reader = SimCoefficientsReader_open(instance->config);
+
+    if (reader == NULL) return false;
+
+    const SimCoefficientsColumns* columns = SimCoefficientsReader_getColumns(reader);
+
+    if (columns != NULL && columns->named && columns->count == instance->end - instance->first && columns->key == instance->referencesKey)
+    {
+        copyCoefficients(set, instance, columns);
+        instance->configCurrent = true;
+        SimCoefficientsReader_close(reader);
+        return true;
+    }
+
+    SimCoefficientsEntry entry;
+    int unmatched = 0;
+
+    while (SimCoefficientsReader_next(reader, &entry))
+    {
+        // by object reference - the positional index only for entries without one
+        int i = -1;
+        if (entry.name != NULL)
+            i = SimIndex_get(instance->index, entry.name);
+        else if (entry.i >= 0 && instance->first + entry.i < instance->end)
+            i = instance->first + entry.i;
+
+        if (i < 0)
+        {
+            unmatched++;
+            continue;
+        }
+
+        applyCoefficients(set, i, &entry);
+    }
+
+    bool failed = SimCoefficientsReader_hasFailed(reader);
+
+    if (failed)
+        printf("Warning - %s is damaged, its coefficients are only partly loaded\n", instance->config);
+    if (unmatched > 0)
+        printf("Warning - %d data point(s) of %s do not match the model\n", unmatched, instance->config);
+
+    SimCoefficientsReader_close(reader);
+    return !failed;
+}
+
+static const char* dataPointTypeName(DataAttributeType type)
+{
+    switch (type)
+    {
+        case IEC61850_BOOLEAN: return "IEC61850_BOOLEAN";
+        case IEC61850_INT8: return "IEC61850_INT8";
+        case IEC61850_INT16: return "IEC61850_INT16";
+        case IEC61850_INT32: return "IEC61850_INT32";
+        case IEC61850_INT64: return "IEC61850_INT64";
+        case IEC61850_INT8U: return "IEC61850_INT8U";
+        case IEC61850_INT16U: return "IEC61850_INT16U";
+        case IEC61850_INT24U:
+        case IEC61850_INT32U: return "IEC61850_INT24/32U";
+        case IEC61850_FLOAT32: return "IEC61850_FLOAT32";
+        case IEC61850_FLOAT64: return "IEC61850_FLOAT64";
+        default: return NULL;
+    }
+}
+
+// (re)generates the configuration of an instance, in the format of its file name (*.bin - binary, otherwise XML);
+// a binary configuration that was copied as a whole is left as it is
+void saveCoefficients(SimInstance* instance)
+{
+    char reference[256];
+
+    if (instance->config[0] == 0 || instance->configCurrent) return;
+
+    SimCoefficientsWriter writer = SimCoefficientsWriter_create(instance->config, SimCoefficients_getFormat(instance->config));
+
+    if (writer == NULL)
+    {
+        printf("Warning - cannot write %s\n", instance->config);
+        return;
+    }
+
+    for (int i = instance->first; i < instance->end; i++) 
+    {
+        SimCoefficientsEntry entry = {
+            .name = dataPointReference(i, reference, sizeof(reference)),
+            .i = i - instance->first,
+            .period = dataPointsPeriod[i],
+            .deadband = dataPointsDeadband[i],
+            .deadbandRelative = dataPointsDeadbandRel[i],
+            .type = dataPointTypeName(dataPointsValues[i]->type),
+            .X = { A[i], B[i], C[i], D[i] },
+            .Xr = { Ar[i], Br[i], Cr[i], Dr[i] }
+        };
+
+        SimCoefficientsWriter_write(writer, &entry);
+    }
+
+    if (!SimCoefficientsWriter_close(writer))
+        printf("Warning - cannot write %s\n", instance->config);
+}
+
+// the columns of the table as a coefficient set
+static CoefficientSet tableCoefficients()
+{
+    CoefficientSet set = { { A, B, C, D }, { Ar, Br, Cr, Dr }, dataPointsDeadband, dataPointsDeadbandRel, dataPointsPeriod };
+    return set;
+}
+
+// exchanges the columns of the table with the ones of a set - only between two ticks
+static void swapCoefficients(CoefficientSet* set)
+{
+    float** table[10] = { &A, &B, &C, &D, &Ar, &Br, &Cr, &Dr, &dataPointsDeadband, &dataPointsDeadbandRel };
+    float** columns[10] = { &set->X[0], &set->X[1], &set->X[2], &set->X[3], &set->Xr[0], &set->Xr[1], &set->Xr[2], &set->Xr[3], &set->deadband, &set->deadbandRelative };
+
+    for (int k = 0; k < 10; k++)
+    {
+        float* column = *table[k];
+        *table[k] = *columns[k];
+        *columns[k] = column;
+    }
+}
+
+static bool createReloadSet()
+{
+    float** columns[10] = { &reloadSet.X[0], &reloadSet.X[1], &reloadSet.X[2], &reloadSet.X[3], &reloadSet.Xr[0], &reloadSet.Xr[1], &reloadSet.Xr[2], &reloadSet.Xr[3], &reloadSet.deadband, &reloadSet.deadbandRelative };
+
+    for (int k = 0; k < 10; k++)
+        if ((*columns[k] = resizeColumn(NULL, sizeof(float), dataPointsCapacity, true)) == NULL)
+            return false;
+
+    reloadSet.period = NULL;
+    spareCoefficients = &reloadSet;
+    return true;
+}
+
+// instance of each watched configuration
+static int watchedInstances[MAX_INSTANCES];
+
+// on the thread of the watcher - the changed configuration is loaded into the spare set (on top of the active
+// coefficients) and handed over to the simulation, which never waits for it
+static void reloadCoefficients(void* parameter, int file)
+{
+    SimInstance* instance = &instances[watchedInstances[file]];
+    uint64_t started = Hal_getTimeInNs();
+    CoefficientSet* set;
+
+    // the previous reload is swapped in with the next tick
+    while ((set = __atomic_exchange_n(&spareCoefficients, NULL, __ATOMIC_ACQUIRE)) == NULL && running)
+        Thread_sleep(1);
+
+    if (set == NULL) return;
+
+    // the active columns are only read while the simulation runs
+    CoefficientSet table = tableCoefficients();
+    size_t size = dataPointsCapacity * sizeof(float);
+
+    for (int c = 0; c < 4; c++)
+    {
+        memcpy(set->X[c], table.X[c], size);
+        memcpy(set->Xr[c], table.Xr[c], size);
+    }
+    memcpy(set->deadband, table.deadband, size);
+    memcpy(set->deadbandRelative, table.deadbandRelative, size);
+
+    if (!loadCoefficients(instance, set))
+    {
+        printf("Warning - coefficients of %s not reloaded, %s can not be read\n", instance->name, instance->config);
+        __atomic_store_n(&spareCoefficients, set, __ATOMIC_RELEASE);
+        return;
+    }
+
+    __atomic_store_n(&pendingCoefficients, set, __ATOMIC_RELEASE);
+    printf("Coefficients of %s reloaded from %s (%.1f ms)\n", instance->name, instance->config, (Hal_getTimeInNs() - started) / 1e6);
+}
+
+// true if the value moved enough (relative to the last reported one) to be pushed into the model
+static bool passesChangeFilter(SimPartition* partition, int i, double value, bool analog)
+{
+    if (!dataPointsReportedValid[i])
+    {
+        dataPointsReportedValid[i] = true;
+        dataPointsReported[i] = value;
+        return true;
+    }
+
+    double delta = fabs(value - dataPointsReported[i]);
+
+    double threshold = 0.0;
+
+    // the deadbands apply to numeric values only - a boolean changes by 1 or not at all
+    if (analog)
+    {
+        double deadband = isnan(dataPointsDeadband[i]) ? defaultDeadband : dataPointsDeadband[i];
+        double deadbandRel = isnan(dataPointsDeadbandRel[i]) ? defaultDeadbandRel : dataPointsDeadbandRel[i];
+
+        threshold = deadband;
+        if (deadbandRel * fabs(dataPointsReported[i]) > threshold)
+            threshold = deadbandRel * fabs(dataPointsReported[i]);
+    }
+
+    if ((threshold > 0.0 && delta <= threshold) || (filterUnchanged && delta == 0.0))
+    {
+        partition->suppressed++;
+        return false;
+    }
+
+    dataPointsReported[i] = value;
+    return true;
+}
+
+// stages one (already evaluated) data point for the commit phase - no lock needed
+static void stageDataPoint(SimPartition* partition, int i, bool log_simulation)
+{
+    DataAttribute* dPT = dataPointsTimestamps[i];
+    DataAttribute* dPV = dataPointsValues[i];
+
+    if (dPT == NULL || dPV == NULL) return;
+
+    float simVal = simValues[i];
+
+    StagedUpdate* update = &partition->staged[partition->stagedCount];
+    update->point = i;
+    update->simulated = simVal;
+    
+    if (dPV->type == IEC61850_FLOAT32 ||
+        dPV->type == IEC61850_FLOAT64)
+    {
+        update->kind = STAGED_FLOAT;
+        update->value.f = simVal;
+    } else
+    if (dPV->type == IEC61850_INT8 ||
+        dPV->type == IEC61850_INT16 ||
+        dPV->type == IEC61850_INT32)
+    {
+        update->kind = STAGED_INT32;
+        update->value.i = simVal;
+    } else
+    if (dPV->type == IEC61850_INT64)
+    {
+        update->kind = STAGED_INT64;
+        update->value.l = simVal;
+    } else            
+    if (dPV->type == IEC61850_INT8U ||
+        dPV->type == IEC61850_INT16U ||
+        dPV->type == IEC61850_INT24U ||
+        dPV->type == IEC61850_INT32U)
+    {
+        update->kind = STAGED_UINT32;
+        update->value.u = abs(simVal);
+    } else
+    if (dPV->type == IEC61850_BOOLEAN)
+    {
+        update->kind = STAGED_BOOLEAN;
+        update->value.b = simVal >= 0.0f;
+    }
+    else
+        return;
+
+    double reported;
+    switch (update->kind)
+    {
+        case STAGED_FLOAT: reported = update->value.f; break;
+        case STAGED_INT32: reported = update->value.i; break;
+        case STAGED_INT64: reported = update->value.l; break;
+        case STAGED_UINT32: reported = update->value.u; break;
+        default: reported = update->value.b; break;
+    }
+    if (!passesChangeFilter(partition, i, reported, update->kind != STAGED_BOOLEAN))
+        return;
+
+    // only the values that are written - one printf per line, the workers log concurrently
+    if (log_simulation)
+    {
+        char path[256];
+        modelNodePath(dPV->parent, path, sizeof(path));
+
+        switch (update->kind)
+        {
+            case STAGED_FLOAT: printf("%s.%s [FLOAT] <- %f\n", path, dPV->name, update->value.f); break;
+            case STAGED_INT32: printf("%s.%s [INT]  <- %d\n", path, dPV->name, update->value.i); break;
+            case STAGED_INT64: printf("%s.%s [LONG] <- %ld\n", path, dPV->name, update->value.l); break;
+            case STAGED_UINT32: printf("%s.%s [UINT] <- %u\n", path, dPV->name, update->value.u); break;
+            default: printf("%s.%s [BOOL] <- %s\n", path, dPV->name, update->value.b ? "true" : "false"); break;
+        }
+    }
+
+    partition->stagedCount++;
+}
+
+// scheduled mode - update period of a data point [ticks], points without a period of their own get the default
+static uint64_t getPeriodTicks(int i)
+{
+    if (dataPointsPeriod[i] == 0) return tickJob.defaultPeriod;
+
+    return ((uint64_t) dataPointsPeriod[i] * tickJob.frequency + 999) / 1000;
+}
+
+static int compareStagedPoints(const void* a, const void* b)
+{
+    int pointA = ((const StagedUpdate*) a)->point;
+    int pointB = ((const StagedUpdate*) b)->point;
+
+    return (pointA > pointB) - (pointA < pointB);
+}
+
+// evaluates and stages the points of [first, end) that belong to the partition
+static void stageRange(SimPartition* partition, int first, int end, double t, uint64_t tick)
+{
+    if (first < partition->first) first = partition->first;
+    if (end > partition->end) end = partition->end;
+    if (end <= first) return;
+
+    evaluateDataPoints(first, end - first, t, tick);
+
+    for (int i = first; i < end; i++)
+        stageDataPoint(partition, i, tickJob.log);
+}
+
+// phase one of a tick for the partition of a worker - evaluates and stages the points to update
+static void simulatePartition(void* parameter, int worker)
+{
+    SimPartition* partition = &partitions[worker];
+    int size = partition->end - partition->first;
+
+    if (size == 0) return;
+
+    uint64_t started = Hal_getTimeInNs();
+    uint64_t tick = tickJob.tick;
+    double t = tickJob.t;
+
+    if (tickJob.mode == SIM_MODE_SCHEDULED)
+    {
+        // only the points that are due
+        int due = SimWheel_advance(partition->wheel, tick, partition->duePoints);
+
+        for (int n = 0; n < due; n++)
+        {
+            int point = partition->duePoints[n];
+            int i = partition->first + point;
+            evaluateDataPoints(i, 1, t, tick);
+            stageDataPoint(partition, i, tickJob.log);
+
+            SimWheel_schedule(partition->wheel, point, SimWheel_getDue(partition->wheel, point) + getPeriodTicks(i));
+        }
+    }
+    else if (deterministic)
+    {
+        // the tick's batch is chosen over all points and every partition takes the ones in its range, so the
+        // updates do not depend on the number of workers
+        if (tickJob.mode == SIM_MODE_LEGACY)
+        {
+            for (int n = 0; n < tickJob.batch; n++)
+            {
+                int i = (int)(((SimRandom_keyed(deterministicSeed, tick, (4ULL << 32) + n) >> 32) * (uint64_t) dataPointsCount) >> 32);
+
+                if (i < partition->first || i >= partition->end) continue;
+
+                // picks with replacement - a point is staged once per tick, at most the size of the partition
+                if (partition->pickedTick[i - partition->first] == tick + 1) continue;
+                partition->pickedTick[i - partition->first] = tick + 1;
+
+                evaluateDataPoints(i, 1, t, tick);
+                stageDataPoint(partition, i, tickJob.log);
+            }
+        }
+        else
+        {
+            // [cursor, cursor + batch) of the sweep through all points
+            int end = tickJob.cursor + tickJob.batch;
+
+            stageRange(partition, tickJob.cursor, end, t, tick);
+            if (end > dataPointsCount)
+                stageRange(partition, 0, end - dataPointsCount, t, tick);
+        }
+    }
+    else
+    {
+        // share of the tick's batch proportional to the size of the partition
+        partition->batchBudget += (double) tickJob.batch * size / dataPointsCount;
+        int batch = (int) partition->batchBudget;
+        partition->batchBudget -= batch;
+        if (batch > size) batch = size;
+
+        if (tickJob.mode == SIM_MODE_LEGACY)
+        {
+            // random data points
+            for (int n = 0; n < batch; n++)
+            {
+                int i = partition->first + (int) SimRandom_range(SimRandom_thread(), size);
+                evaluateDataPoints(i, 1, t, tick);
+                stageDataPoint(partition, i, tickJob.log);
+            }
+        }
+        else
+        {
+            // sweep through the partition, so every point is touched once per pass
+            int first = partition->batchCursor;
+            int count = (batch < partition->end - first) ? batch : partition->end - first;
+
+            evaluateDataPoints(first, count, t, tick);
+            if (count < batch)
+                evaluateDataPoints(partition->first, batch - count, t, tick);
+
+            for (int n = 0; n < batch; n++)
+            {
+                stageDataPoint(partition, partition->batchCursor, tickJob.log);
+                if (++partition->batchCursor >= partition->end) partition->batchCursor = partition->first;
+            }
+        }
+    }
+
+    // deterministic replay - committed and traced in the order of the points, whatever the number of workers
+    if (deterministic && partition->stagedCount > 1)
+        qsort(partition->staged, partition->stagedCount, sizeof(StagedUpdate), compareStagedPoints);
+
+    partition->updates += partition->stagedCount;
+    partition->busyNs += Hal_getTimeInNs() - started;
+}
+
+// splits the data points into contiguous partitions of about equal size, optionally without splitting logical devices
+static void createPartitions(int count, bool byDevice, bool scheduled, uint64_t tick)
+{
+    if (count > dataPointsCount) count = dataPointsCount;
+    if (count < 1) count = 1;
+
+    partitions = (SimPartition*) calloc(count, sizeof(SimPartition));
+    partitionsCount = count;
+
+    int first = 0;
+    for (int w = 0; w < count; w++)
+    {
+        int end = (int)((int64_t) dataPointsCount * (w + 1) / count);
+        if (end < first) end = first;
+
+        if (byDevice)
+            while (end > first && end < dataPointsCount && dataPointsDevice[end] == dataPointsDevice[end - 1])
+                end++;
+
+        SimPartition* partition = &partitions[w];
+        partition->first = first;
+        partition->end = end;
+        partition->batchCursor = first;
+        partition->staged = (StagedUpdate*) calloc(end - first + 1, sizeof(StagedUpdate));
+        if (deterministic)
+            partition->pickedTick = (uint64_t*) calloc(end - first + 1, sizeof(uint64_t));
+
+        if (scheduled)
+        {
+            partition->wheel = SimWheel_create(end - first, tick);
+            partition->duePoints = (int*) calloc(end - first + 1, sizeof(int));
+        }
+
+        first = end;
+    }
+}
+
+static void destroyPartitions()
+{
+    for (int w = 0; w < partitionsCount; w++)
+    {
+        SimWheel_destroy(partitions[w].wheel);
+        free(partitions[w].duePoints);
+        free(partitions[w].staged);
+        free(partitions[w].pickedTick);
+    }
+
+    free(partitions);
+    partitions = NULL;
+    partitionsCount = 0;
+}
+
+static uint64_t lockAcquired = 0;
+
+static void lockInstance(SimInstance* instance)
+{
+    uint64_t lockRequested = Hal_getTimeInNs();
+    IedServer_lockDataModel(instance->iedServer);
+    lockAcquired = Hal_getTimeInNs();
+
+    lockStatistics.waitSum += lockAcquired - lockRequested;
+}
+
+static void unlockInstance(SimInstance* instance)
+{
+    IedServer_unlockDataModel(instance->iedServer);
+    uint64_t lockHeld = Hal_getTimeInNs() - lockAcquired;
+
+    lockStatistics.count++;
+    lockStatistics.holdSum += lockHeld;
+    if (lockHeld > lockStatistics.holdMax) lockStatistics.holdMax = lockHeld;
+}
+
+// pushes the staged values of all partitions into the data models - partitions and instances are both
+// contiguous ranges of data points, so the data model of each instance is locked once per tick
+// elements of an array have no model nodes - the element is updated in place (read by clients, not reported)
+static void updateArrayElement(DataAttribute* dataAttribute, int element, StagedUpdate* update)
+{
+    MmsValue* value = MmsValue_getElement(dataAttribute->mmsValue, element);
+
+    if (value == NULL) return;
+
+    switch (update->kind)
+    {
+        case STAGED_FLOAT: MmsValue_setFloat(value, update->value.f); break;
+        case STAGED_INT32: MmsValue_setInt32(value, update->value.i); break;
+        case STAGED_INT64: MmsValue_setInt64(value, update->value.l); break;
+        case STAGED_UINT32: MmsValue_setUint32(value, update->value.u); break;
+        case STAGED_BOOLEAN: MmsValue_setBoolean(value, update->value.b); break;
+    }
+}
+
+static void commitStagedUpdates(Timestamp* iecTimestamp, Quality iecQuality)
+{
+    SimInstance* locked = NULL;
+
+    for (int w = 0; w < partitionsCount; w++)
+    {
+        SimPartition* partition = &partitions[w];
+
+        for (int n = 0; n < partition->stagedCount; n++)
+        {
+            StagedUpdate* update = &partition->staged[n];
+            DataAttribute* dPV = dataPointsValues[update->point];
+            SimInstance* instance = &instances[dataPointsInstance[update->point]];
+            IedServer iedServer = instance->iedServer;
+
+            if (instance != locked)
+            {
+                if (locked != NULL) unlockInstance(locked);
+                lockInstance(instance);
+                locked = instance;
+            }
+
+            IedServer_updateTimestampAttributeValue(iedServer, dataPointsTimestamps[update->point], iecTimestamp);
+            if (dataPointsQuality[update->point] != NULL)
+                IedServer_updateQuality(iedServer, dataPointsQuality[update->point], iecQuality);
+
+            if (dataPointsElement[update->point] >= 0)
+                updateArrayElement(dPV, dataPointsElement[update->point], update);
+            else
+            switch (update->kind)
+            {
+                case STAGED_FLOAT: IedServer_updateFloatAttributeValue(iedServer, dPV, update->value.f); break;
+                case STAGED_INT32: IedServer_updateInt32AttributeValue(iedServer, dPV, update->value.i); break;
+                case STAGED_INT64: IedServer_updateInt64AttributeValue(iedServer, dPV, update->value.l); break;
+                case STAGED_UINT32: IedServer_updateUnsignedAttributeValue(iedServer, dPV, update->value.u); break;
+                case STAGED_BOOLEAN: IedServer_updateBooleanAttributeValue(iedServer, dPV, update->value.b); break;
+            }
+
+            if (instance->buffers != NULL)
+                SimBuffers_trigger(instance->buffers, update->point - instance->first);
+        }
+
+        writeCounter += partition->stagedCount;
+    }
+
+    if (locked != NULL) unlockInstance(locked);
+}
+
+// integer attribute of a manifest instance, an invalid or out of range value is ignored with a warning
+static void getManifestInteger(xmlNode* node, int instance, const char* name, int min, int max, int* result)
+{
+    xmlChar* value = xmlGetProp(node, BAD_CAST name);
+
+    if (value == NULL) return;
+
+    char* end = NULL;
+    errno = 0;
+    long parsed = strtol((const char*) value, &end, 10);
+
+    if (errno != 0 || end == (char*) value || *end != 0 || parsed < min || parsed > max)
+        printf("Warning - manifest instance #%d: invalid %s '%s' (%d..%d), ignoring it\n", instance, name, (const char*) value, min, max);
+    else
+        *result = (int) parsed;
+
+    xmlFree(value);
+}
+
+// instances listed in the manifest
+//   <Instances>
+//     <Instance name="IED1" model="/models/PM.cfg" port="1001" ip="10.0.0.1" frequency="5" config="/config/IED1.xml"
+//               brcbBufferSize="100000" urcbBufferSize="20000"/>
+//     ...
+//   </Instances>
+bool loadManifest(const char* filename)
+{
+    xmlDoc *doc = NULL;
+    xmlNode *nodeRoot = NULL;
+
+    LIBXML_TEST_VERSION
+
+    doc = xmlReadFile(filename, NULL, 0);
+
+    if (doc == NULL) return false;
+
+    nodeRoot = xmlDocGetRootElement(doc);
+
+    instances = (SimInstance*) calloc(MAX_INSTANCES, sizeof(SimInstance));
+    instancesCount = 0;
+
+    for (xmlNode *nodeInstance = nodeRoot->children; nodeInstance; nodeInstance = nodeInstance->next)
+    {
+        if (nodeInstance->type != XML_ELEMENT_NODE || xmlStrcmp(nodeInstance->name, BAD_CAST "Instance")) continue;
+
+        if (instancesCount == MAX_INSTANCES)
+        {
+            printf("Warning - maximum number (%d) of instances reached, ignoring the rest of the manifest\n", MAX_INSTANCES);
+            break;
+        }
+
+        SimInstance* instance = &instances[instancesCount];
+        xmlChar* value;
+
+        if ((value = xmlGetProp(nodeInstance, BAD_CAST "name")) != NULL) { snprintf(instance->name, sizeof(instance->name), "%s", value); xmlFree(value); }
+        if ((value = xmlGetProp(nodeInstance, BAD_CAST "model")) != NULL) { snprintf(instance->model, sizeof(instance->model), "%s", value); xmlFree(value); }
+        if ((value = xmlGetProp(nodeInstance, BAD_CAST "ied")) != NULL) { snprintf(instance->ied, sizeof(instance->ied), "%s", value); xmlFree(value); }
+        if ((value = xmlGetProp(nodeInstance, BAD_CAST "config")) != NULL) { snprintf(instance->config, sizeof(instance->config), "%s", value); xmlFree(value); }
+        if ((value = xmlGetProp(nodeInstance, BAD_CAST "ip")) != NULL) { snprintf(instance->ip, sizeof(instance->ip), "%s", value); xmlFree(value); }
+        getManifestInteger(nodeInstance, instancesCount + 1, "port", 1, 65535, &instance->port);
+        getManifestInteger(nodeInstance, instancesCount + 1, "frequency", 1, 1000000, &instance->frequency);
+        getManifestInteger(nodeInstance, instancesCount + 1, "brcbBufferSize", 1, INT_MAX, &instance->brcbBufferSize);
+        getManifestInteger(nodeInstance, instancesCount + 1, "urcbBufferSize", 1, INT_MAX, &instance->urcbBufferSize);
+
+        if (instance->name[0] == 0 || instance->model[0] == 0)
+        {
+            printf("Warning - manifest instance #%d without name or model, ignoring\n", instancesCount + 1);
+            memset(instance, 0, sizeof(SimInstance));
+            continue;
+        }
+        if (instance->port <= 0) instance->port = 102;
+
+        instancesCount++;
+    }
+
+    xmlFreeDoc(doc);
+    xmlCleanupParser();
+
+    return true;
+}
+
+// creates (and starts) the server of an instance
+bool startInstance(SimInstance* instance, IedServerConfig config, bool threadless)
+{
+    for (int t = 0; t < modelTemplatesCount && instance->modelTemplate == NULL; t++)
+        if (strcmp(SimModelTemplate_getFilename(modelTemplates[t]), instance->model) == 0 &&
+            strcmp(SimModelTemplate_getIedName(modelTemplates[t]), instance->ied) == 0)
+            instance->modelTemplate = modelTemplates[t];
+
+    if (instance->modelTemplate == NULL)
+    {
+        uint64_t started = Hal_getTimeInMs();
+        instance->modelTemplate = SimModelTemplate_load(instance->model, instance->ied, modelCacheDirectory);
+        if (instance->modelTemplate == NULL)
+        {
+            printf("Failed! (cannot load model '%s')\n", instance->model);
+            return false;
+        }
+        modelTemplates[modelTemplatesCount++] = instance->modelTemplate;
+        printf("model %s in %lu ms... ", SimModelTemplate_isCached(instance->modelTemplate) ? "mapped from cache" : "loaded",
+            Hal_getTimeInMs() - started);
+    }
+
+    instance->iedModel = SimModelTemplate_instantiate(instance->modelTemplate);
+    if (instance->iedModel == NULL)
+    {
+        printf("Failed! (out of memory)\n");
+        return false;
+    }
+    IedModel_setIedName(instance->iedModel, instance->name);
+
+    // before the server is created, it sets up the control blocks of the model
+    instance->reports = SimReports_generate(instance->iedModel, &reportsConfig);
+    if (instance->reports != NULL)
+        printf("%d data sets, %d report control blocks generated... ", SimReports_getDataSetCount(instance->reports), SimReports_getReportCount(instance->reports));
+
+    // the server allocates a buffer of the size for each control block
+    IedServerConfig_setReportBufferSize(config, instance->brcbBufferSize);
+    IedServerConfig_setReportBufferSizeForURCBs(config, instance->urcbBufferSize);
+
+    // New IEC 61850 server instance
+    instance->iedServer = IedServer_createWithConfig(instance->iedModel, NULL, config);
+    IedServer_setServerIdentity(instance->iedServer, "sting GmbH", "Fuzzy IEC61850 Simulator", "1.1");
+    if (instance->ip[0] != 0)
+        IedServer_setLocalIpAddress(instance->iedServer, instance->ip);
+
+    // Authentication
+    if (auth_password != NULL)
+        IedServer_setAuthenticator(instance->iedServer, clientAuthenticator, NULL);
+
+        /*
+        AcseAuthenticationParameter auth = calloc(1, sizeof(struct sAcseAuthenticationParameter));
+        auth->mechanism = ACSE_AUTH_PASSWORD;
+        auth->value.password.octetString = "testpw";
+        
+        IsoServer_setAuthenticationParameter(iedServer, auth);        
+        */
+
+    // Tracking connections
+    IedServer_setConnectionIndicationHandler(instance->iedServer, (IedConnectionIndicationHandler) connectionHandler, instance);
+
+    // Read access handler (only to count reads)
+    IedServer_setReadAccessHandler(instance->iedServer, readAccessHandler, NULL);
+
+    // start server
+    if (threadless)
+        IedServer_startThreadless(instance->iedServer, instance->port);
+    else
+        IedServer_start(instance->iedServer, instance->port);
+    if (!IedServer_isRunning(instance->iedServer)) {
+        printf("Failed! (maybe need root permissions or another server is already using the port %d)!\n", instance->port);
+        IedServer_destroy(instance->iedServer);
+        instance->iedServer = NULL;
+        SimReports_destroy(instance->reports);
+        instance->reports = NULL;
+        SimModelTemplate_destroyInstance(instance->iedModel);
+        instance->iedModel = NULL;
+        return false;
+    }
+
+    // report buffers of all control blocks, their occupancy is estimated from the simulated values
+    int brcbs = 0, urcbs = 0;
+    for (ReportControlBlock* rcb = instance->iedModel->rcbs; rcb != NULL; rcb = rcb->sibling)
+        if (rcb->buffered) brcbs++; else urcbs++;
+
+    if (brcbs + urcbs > 0)
+    {
+        instance->buffers = SimBuffers_create(instance->iedModel, instance->brcbBufferSize, instance->urcbBufferSize, reportBufferRetention);
+        printf("%lu kB report buffers... ", ((unsigned long) brcbs * instance->brcbBufferSize + (unsigned long) urcbs * instance->urcbBufferSize) / 1024);
+    }
+
+    return true;
+}
+
+void stopInstance(SimInstance* instance, bool threadless)
+{
+    if (instance->iedServer == NULL) return;
+
+    // stop server, close TCP server and client sockers
+    if (threadless)
+        IedServer_stopThreadless(instance->iedServer);
+    else
+        IedServer_stop(instance->iedServer);
+
+    // cleanup / free resources
+    IedServer_destroy(instance->iedServer);
+    instance->iedServer = NULL;
+
+    SimBuffers_destroy(instance->buffers);
+    instance->buffers = NULL;
+
+    SimReports_destroy(instance->reports);
+    instance->reports = NULL;
+
+    SimModelTemplate_destroyInstance(instance->iedModel);
+    instance->iedModel = NULL;
+
+    SimIndex_destroy(instance->index);
+    instance->index = NULL;
+}
+
+static uint32_t logicalDevicesCount = 0;
+
+// default coefficients of a new data point by the type of its value (replaced by the loaded ones)
+static void defaultCoefficients(int i, DataAttribute* dP, bool log_modeling)
+{
+    if (dP->type == IEC61850_BOOLEAN)
+    {
+        if isnan(B[i]) { B[i] = 1.0f; Br[i] = 0.01f; }
+
+        if (log_modeling) printf(" [IEC61850_BOOLEAN]");
+    }
+    if (dP->type == IEC61850_INT8)
+    {
+        if isnan(B[i]) { B[i] = 0.95f * INT8_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_INT8]");
+    }
+    if (dP->type == IEC61850_INT16)
+    {
+        if isnan(B[i]) { B[i] = 0.95f * INT16_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_INT16]");
+    }
+    if (dP->type == IEC61850_INT32)
+    {
+        if isnan(B[i]) { B[i] = 0.95f * INT32_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_INT32]");
+    }
+    if (dP->type == IEC61850_INT64)
+    {
+        if isnan(B[i]) { B[i] = 0.95f * INT64_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_INT64]");
+    }
+    if (dP->type == IEC61850_INT8U)
+    {
+        if isnan(A[i]) { A[i] = 0.5f * INT8_MAX; Br[i] = 0.00f; }
+        if isnan(B[i]) { B[i] = 0.45f * INT8_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_INT8U]");
+    }
+    if (dP->type == IEC61850_INT16U)
+    {
+        if isnan(A[i]) { A[i] = 0.5f * INT16_MAX; Br[i] = 0.00f; }
+        if isnan(B[i]) { B[i] = 0.45f * INT16_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_INT16U]");
+    }
+    if (dP->type == IEC61850_INT24U ||
+        dP->type == IEC61850_INT32U)
+    {
+        if isnan(A[i]) { A[i] = 0.5f * INT32_MAX; Br[i] = 0.00f; }
+        if isnan(B[i]) { B[i] = 0.45f * INT32_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_INT24/32U]");
+    }
+    if (dP->type == IEC61850_FLOAT32)
+    {
+        if isnan(B[i]) { B[i] = 0.95f * FLT_MAX; Br[i] = 0.05f; }
+
+        if (log_modeling) printf(" [IEC61850_FLOAT32]");
+    }
+    if (dP->type == IEC61850_FLOAT64)
+    {
+        if isnan(B[i]) { B[i] = 0.95f * DBL_MAX; Br[i] = 0.05f;}
+
+        if (log_modeling) printf(" [IEC61850_FLOAT64]");
+    }
+
+    if isnan(A[i]) { A[i] = 0.0f; Ar[i] = 0.01f; }
+    if isnan(B[i]) { B[i] = 1.0f; Br[i] = 0.01f; }
+    if isnan(C[i]) { C[i] = sim(1,0.8); Cr[i] = 0.01f; }          // time 0.2..1.8 randomness 1%
+    if isnan(D[i]) { D[i] = sim(M_PI, 1.0); Dr[i] = 0.1f; }       // phase 0..2*PI randomness 10%
+
+    if (log_modeling) printf("   A: %f ± %0.0f%%   B: %f ± %0.0f%%   C: %f ± %0.0f%%   D: %f ± %0.0f%%", A[i], 100*Ar[i], B[i], 100*Br[i], C[i], 100*Cr[i], D[i], 100*Dr[i] );
+}
+
+// browses the model of an instance and appends its data points (all simulatable leaves) to the table
+static void browseInstance(SimInstance* instance, bool log_modeling)
+{
+    int leavesCount = 0;
+    SimLeaf* leaves = SimVisitor_collectLeaves(instance->iedModel, &leavesCount);
+
+    if (leaves == NULL || !reserveDataPoints(dataPointsCount + leavesCount))
+    {
+        printf("Error - cannot allocate the data points of %s. Terminating...", instance->name);
+        exit(EXIT_FAILURE);
+    }
+
+    instance->index = SimIndex_create(leavesCount);
+    instance->referencesKey = SIM_COEFFICIENTS_KEY;
+    if (instance->index == NULL)
+    {
+        printf("Error - cannot allocate the data point index of %s. Terminating...", instance->name);
+        exit(EXIT_FAILURE);
+    }
+
+    LogicalDevice* logicalDevice = NULL;
+
+    for (int n = 0; n < leavesCount; n++)
+    {
+        SimLeaf* leaf = &leaves[n];
+        int i = dataPointsCount;
+
+        // device indices stay unique across instances
+        if (leaf->logicalDevice != logicalDevice)
+        {
+            if (logicalDevice != NULL) logicalDevicesCount++;
+            logicalDevice = leaf->logicalDevice;
+            if (log_modeling) printf("Logical device - %s\n", logicalDevice->name);
+        }
+
+        dataPointsValues[i] = leaf->value;
+        dataPointsElement[i] = leaf->element;
+        dataPointsTimestamps[i] = leaf->timestamp;
+        dataPointsQuality[i] = leaf->quality;
+        if (dataPointsPeriod[i] == 0)
+            dataPointsPeriod[i] = lookupRateClass(leaf->logicalNode->name);
+        if (dataPointsPeriod[i] == 0 && instance->frequency > 0)
+            dataPointsPeriod[i] = (instance->frequency < 1000) ? 1000 / instance->frequency : 1;
+        dataPointsDevice[i] = logicalDevicesCount;
+        dataPointsInstance[i] = instance - instances;
+
+        char reference[256];
+        dataPointReference(i, reference, sizeof(reference));
+        instance->referencesKey = SimCoefficients_addToKey(instance->referencesKey, reference);
+        if (!SimIndex_put(instance->index, reference, i))
+        {
+            printf("Error - cannot index the data points of %s. Terminating...", instance->name);
+            exit(EXIT_FAILURE);
+        }
+
+        if (log_modeling) printf("  %s", reference);
+        defaultCoefficients(i, leaf->value, log_modeling);
+        if (log_modeling) printf("   --- %d ---\n", i + 1);
+
+        dataPointsCount++;
+    }
+
+    if (logicalDevice != NULL) logicalDevicesCount++;
+
+    free(leaves);
+}
+
+// Ethernet address "01:0C:CD:01:00:00"
+static bool parseAddress(const char* text, uint8_t* address)
+{
+    uint8_t parsed[6];
+
+    if (sscanf(text, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", &parsed[0], &parsed[1], &parsed[2], &parsed[3], &parsed[4], &parsed[5]) != 6)
+        return false;
+
+    memcpy(address, parsed, sizeof(parsed));
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    char* ied_name = (getenv("IED_NAME") == NULL) ? "IED" : getenv("IED_NAME");
+
+    int mms_port = (getenv("MMS_PORT") == NULL) ? 102 : atoi(getenv("MMS_PORT"));
+
+    auth_password = (getenv("AUTH_PASSWORD") == NULL) ? NULL : getenv("AUTH_PASSWORD");
+
+    bool log_modeling = (getenv("LOG_MODELING") != NULL) && (strcmp(getenv("LOG_MODELING"), "true") == 0);
+    bool log_simulation = (getenv("LOG_SIMULATION") != NULL) && (strcmp(getenv("LOG_SIMULATION"), "true") == 0);
+    int simulation_frequency = (getenv("SIMULATION_FREQUENCY") == NULL) ? 1 : atoi(getenv("SIMULATION_FREQUENCY"));    
+    if (simulation_frequency <= 0) simulation_frequency = 1;
+
+    SimCatchUpPolicy simulation_catchup = SIM_CATCHUP_BURST;
+    if (getenv("SIMULATION_CATCHUP") != NULL && !SimScheduler_parsePolicy(getenv("SIMULATION_CATCHUP"), &simulation_catchup))
+        printf("Warning - unknown SIMULATION_CATCHUP '%s', using '%s'\n", getenv("SIMULATION_CATCHUP"), SimScheduler_getPolicyName(simulation_catchup));
+
+    int simulation_batch_size = (getenv("SIMULATION_BATCH_SIZE") == NULL) ? 1 : atoi(getenv("SIMULATION_BATCH_SIZE"));
+    if (simulation_batch_size <= 0) simulation_batch_size = 1;
+
+    int simulation_update_rate = (getenv("SIMULATION_UPDATE_RATE") == NULL) ? 0 : atoi(getenv("SIMULATION_UPDATE_RATE"));
+    if (simulation_update_rate < 0) simulation_update_rate = 0;
+
+    if (getenv("SIMULATION_PERIODS") != NULL)
+        parseRateClasses(getenv("SIMULATION_PERIODS"));
+
+    SimRandomAlgorithm simulation_prng = SIM_RANDOM_XOSHIRO;
+    if (getenv("SIMULATION_PRNG") != NULL && !SimRandom_parseAlgorithm(getenv("SIMULATION_PRNG"), &simulation_prng))
+        printf("Warning - unknown SIMULATION_PRNG '%s', using '%s'\n", getenv("SIMULATION_PRNG"), SimRandom_getAlgorithmName(simulation_prng));
+
+    if (getenv("SIMULATION_SEED") != NULL)
+    {
+        deterministic = true;
+        deterministicSeed = strtoull(getenv("SIMULATION_SEED"), NULL, 0);
+    }
+
+    SimRandom_configure(simulation_prng, deterministic ? deterministicSeed : Hal_getTimeInNs());
+
+    bool simulation_virtual_clock = (getenv("SIMULATION_CLOCK") != NULL) && (strcmp(getenv("SIMULATION_CLOCK"), "virtual") == 0);
+    if (getenv("SIMULATION_CLOCK") != NULL && !simulation_virtual_clock && strcmp(getenv("SIMULATION_CLOCK"), "real") != 0)
+        printf("Warning - unknown SIMULATION_CLOCK '%s', using 'real'\n", getenv("SIMULATION_CLOCK"));
+
+    double simulation_duration = (getenv("SIMULATION_DURATION") == NULL) ? 0.0 : atof(getenv("SIMULATION_DURATION"));
+
+    const char* simulation_trace = getenv("SIMULATION_TRACE");
+
+    int simulation_workers = (getenv("SIMULATION_WORKERS") == NULL) ? 1 : atoi(getenv("SIMULATION_WORKERS"));
+    if (simulation_workers < 1) simulation_workers = 1;
+
+    bool simulation_partition_by_device = (getenv("SIMULATION_PARTITION") == NULL) || (strcmp(getenv("SIMULATION_PARTITION"), "count") != 0);
+
+    filterUnchanged = (getenv("SIMULATION_SUPPRESS_UNCHANGED") != NULL) && (strcmp(getenv("SIMULATION_SUPPRESS_UNCHANGED"), "true") == 0);
+    defaultDeadband = (getenv("SIMULATION_DEADBAND") == NULL) ? 0.0f : atof(getenv("SIMULATION_DEADBAND"));
+    defaultDeadbandRel = (getenv("SIMULATION_DEADBAND_RELATIVE") == NULL) ? 0.0f : atof(getenv("SIMULATION_DEADBAND_RELATIVE"));
+
+    const char* simulation_kernel = (getenv("SIMULATION_KERNEL") == NULL) ? "auto" : getenv("SIMULATION_KERNEL");
+
+    bool server_threadless = (getenv("SERVER_THREADLESS") != NULL) && (strcmp(getenv("SERVER_THREADLESS"), "true") == 0);
+
+    const char* ied_manifest = getenv("IED_MANIFEST");
+    const char* ied_model = (getenv("IED_MODEL") == NULL) ? "/model.cid" : getenv("IED_MODEL");
+    if (getenv("REPORTS_GENERATE") != NULL && !SimReports_parseGrouping(getenv("REPORTS_GENERATE"), &reportsConfig.grouping))
+        printf("Warning - unknown REPORTS_GENERATE '%s', using 'none'\n", getenv("REPORTS_GENERATE"));
+    if (getenv("REPORTS_DATASET_SIZE") != NULL)
+        reportsConfig.dataSetSize = atoi(getenv("REPORTS_DATASET_SIZE"));
+    if (getenv("REPORTS_TYPE") != NULL)
+    {
+        reportsConfig.buffered = (strcmp(getenv("REPORTS_TYPE"), "unbuffered") != 0);
+        reportsConfig.unbuffered = (strcmp(getenv("REPORTS_TYPE"), "buffered") != 0);
+    }
+    if (getenv("REPORTS_INSTANCES") != NULL)
+        reportsConfig.instances = atoi(getenv("REPORTS_INSTANCES"));
+    if (getenv("REPORTS_BUFFER_TIME") != NULL)
+        reportsConfig.bufferTime = atoi(getenv("REPORTS_BUFFER_TIME"));
+    if (getenv("REPORTS_INTEGRITY_PERIOD") != NULL)
+        reportsConfig.integrityPeriod = atoi(getenv("REPORTS_INTEGRITY_PERIOD"));
+
+    int report_buffer_size = (getenv("REPORT_BUFFER_SIZE") == NULL) ? REPORT_BUFFER_SIZE : atoi(getenv("REPORT_BUFFER_SIZE"));
+    if (report_buffer_size <= 0) report_buffer_size = REPORT_BUFFER_SIZE;
+    int report_buffer_size_urcb = (getenv("REPORT_BUFFER_SIZE_URCB") == NULL) ? 0 : atoi(getenv("REPORT_BUFFER_SIZE_URCB"));
+    if (getenv("REPORT_BUFFER_RETENTION") != NULL && atoi(getenv("REPORT_BUFFER_RETENTION")) > 0)
+        reportBufferRetention = atoi(getenv("REPORT_BUFFER_RETENTION"));
+
+    bool coefficients_reload = (getenv("COEFFICIENTS_RELOAD") == NULL) || (strcmp(getenv("COEFFICIENTS_RELOAD"), "false") != 0);
+
+    modelCacheDirectory = (getenv("MODEL_CACHE") == NULL) ? "/var/cache/61850-sim" : getenv("MODEL_CACHE");
+    if (modelCacheDirectory[0] == 0)
+        modelCacheDirectory = NULL;
+
+    int iec_61850_edition = (getenv("IEC_61850_EDITION") == NULL) ? IEC_61850_EDITION : atoi(getenv("IEC_61850_EDITION"));
+    int max_mms_connections = (getenv("MAX_MMS_CONNECTIONS") == NULL) ? MAX_MMS_CONNECTIONS : atoi(getenv("MAX_MMS_CONNECTIONS"));
+
+    const char* goose_datasets = getenv("GOOSE_DATASETS");
+    SimGooseConfig gooseConfig = { "eth0", false, 0, 4, 0x1000, { 0x01, 0x0c, 0xcd, 0x01, 0x00, 0x00 }, 4, 1000 };
+    if (getenv("GOOSE_INTERFACE") != NULL)
+        gooseConfig.interface = getenv("GOOSE_INTERFACE");
+    if (getenv("GOOSE_VLAN_ID") != NULL)
+    {
+        gooseConfig.vlan = true;
+        gooseConfig.vlanId = atoi(getenv("GOOSE_VLAN_ID"));
+    }
+    if (getenv("GOOSE_VLAN_PRIORITY") != NULL)
+        gooseConfig.vlanPriority = atoi(getenv("GOOSE_VLAN_PRIORITY"));
+    if (getenv("GOOSE_APPID") != NULL)
+        gooseConfig.appId = strtol(getenv("GOOSE_APPID"), NULL, 0);
+    if (getenv("GOOSE_DST_ADDRESS") != NULL && !parseAddress(getenv("GOOSE_DST_ADDRESS"), gooseConfig.dstAddress))
+        printf("Warning - invalid GOOSE_DST_ADDRESS '%s', using 01:0C:CD:01:00:00\n", getenv("GOOSE_DST_ADDRESS"));
+    if (getenv("GOOSE_MIN_TIME") != NULL && atoi(getenv("GOOSE_MIN_TIME")) > 0)
+        gooseConfig.minTime = atoi(getenv("GOOSE_MIN_TIME"));
+    if (getenv("GOOSE_MAX_TIME") != NULL && atoi(getenv("GOOSE_MAX_TIME")) > 0)
+        gooseConfig.maxTime = atoi(getenv("GOOSE_MAX_TIME"));
+
+    bool sv_publish = (getenv("SV_PUBLISH") != NULL) && (strcmp(getenv("SV_PUBLISH"), "true") == 0);
+    SimSvConfig svConfig = { "eth0", false, 0, 4, 0x4000, { 0x01, 0x0c, 0xcd, 0x04, 0x00, 0x00 }, NULL, 50, 80, 1,
+        { 0.0f, 141.42f, 0.0f }, { 0.0f, 325.27f, 0.0f }, { { 0, 0.0f } }, 0 };
+    char sv_id[130];
+    if (getenv("SV_INTERFACE") != NULL)
+        svConfig.interface = getenv("SV_INTERFACE");
+    if (getenv("SV_VLAN_ID") != NULL)
+    {
+        svConfig.vlan = true;
+        svConfig.vlanId = atoi(getenv("SV_VLAN_ID"));
+    }
+    if (getenv("SV_VLAN_PRIORITY") != NULL)
+        svConfig.vlanPriority = atoi(getenv("SV_VLAN_PRIORITY"));
+    if (getenv("SV_APPID") != NULL)
+        svConfig.appId = strtol(getenv("SV_APPID"), NULL, 0);
+    if (getenv("SV_DST_ADDRESS") != NULL && !parseAddress(getenv("SV_DST_ADDRESS"), svConfig.dstAddress))
+        printf("Warning - invalid SV_DST_ADDRESS '%s', using 01:0C:CD:04:00:00\n", getenv("SV_DST_ADDRESS"));
+    if (getenv("SV_FREQUENCY") != NULL && atoi(getenv("SV_FREQUENCY")) > 0)
+        svConfig.frequency = atoi(getenv("SV_FREQUENCY"));
+    if (getenv("SV_SAMPLES_PER_CYCLE") != NULL && atoi(getenv("SV_SAMPLES_PER_CYCLE")) > 0)
+        svConfig.samplesPerCycle = atoi(getenv("SV_SAMPLES_PER_CYCLE"));
+    if (getenv("SV_ASDUS") != NULL && atoi(getenv("SV_ASDUS")) > 0)
+        svConfig.asdus = (atoi(getenv("SV_ASDUS")) > SIM_SV_MAX_ASDUS) ? SIM_SV_MAX_ASDUS : atoi(getenv("SV_ASDUS"));
+    if (getenv("SV_CURRENT") != NULL && !SimSv_parseWave(getenv("SV_CURRENT"), &svConfig.current))
+        printf("Warning - invalid SV_CURRENT '%s', using A=%g B=%g\n", getenv("SV_CURRENT"), svConfig.current.A, svConfig.current.B);
+    if (getenv("SV_VOLTAGE") != NULL && !SimSv_parseWave(getenv("SV_VOLTAGE"), &svConfig.voltage))
+        printf("Warning - invalid SV_VOLTAGE '%s', using A=%g B=%g\n", getenv("SV_VOLTAGE"), svConfig.voltage.A, svConfig.voltage.B);
+    if (getenv("SV_HARMONICS") != NULL)
+    {
+        svConfig.harmonicsCount = SimSv_parseHarmonics(getenv("SV_HARMONICS"), svConfig.harmonics, SIM_SV_MAX_HARMONICS);
+        if (svConfig.harmonicsCount < 0)
+        {
+            printf("Warning - invalid SV_HARMONICS '%s', using none\n", getenv("SV_HARMONICS"));
+            svConfig.harmonicsCount = 0;
+        }
+    }
+
+    int log_diagnostics_interval = (getenv("LOG_DIAGNOSTICS_INTERVAL") == NULL) ? 5 : atoi(getenv("LOG_DIAGNOSTICS_INTERVAL"));
+
+    if (argc > 1)
+        ied_name = argv[1];
+
+    if (argc > 2)
+        mms_port = atoi(argv[2]);
+
+    if (argc > 3)
+        auth_password = argv[3];
+
+    // instances - from the manifest, or the single IED
+    if (ied_manifest != NULL)
+    {
+        if (!loadManifest(ied_manifest) || instancesCount == 0)
+        {
+            printf("Error - cannot load IED manifest '%s' (or no instances). Terminating...\n", ied_manifest);
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        instances = (SimInstance*) calloc(1, sizeof(SimInstance));
+        instancesCount = 1;
+        snprintf(instances[0].name, sizeof(instances[0].name), "%s", ied_name);
+        // the IED of an SCD, the first one if the file has none of the name
+        snprintf(instances[0].ied, sizeof(instances[0].ied), "%s", ied_name);
+        snprintf(instances[0].model, sizeof(instances[0].model), "%s", ied_model);
+        // the binary coefficients configuration, if one is mapped
+        snprintf(instances[0].config, sizeof(instances[0].config), (access("/config.bin", F_OK) == 0) ? "/config.bin" : "/config.xml");
+        instances[0].port = mms_port;
+    }
+
+    // the merging unit of the (first) IED
+    snprintf(sv_id, sizeof(sv_id), "%sMU01", instances[0].name);
+    svConfig.svId = (getenv("SV_ID") == NULL) ? sv_id : getenv("SV_ID");
+
+    printf("Fuzzy IEC61850 Simulation server\n");
+
+    printf("   libIEC61850 version       : %s\n", LibIEC61850_getVersionString());
+    if (ied_manifest != NULL)
+        printf("   IED manifest              : %s (%d instances)\n", ied_manifest, instancesCount);
+    else
+    {
+        printf("   IED Name                  : %s\n", ied_name);
+        printf("   IED model                 : %s\n", ied_model);
+        printf("   Port                      : %d\n", mms_port);
+    }
+    if (reportsConfig.grouping != SIM_REPORTS_NONE)
+        printf("   Generated reports         : per %s, %d FCDAs per data set, %s%s%s x%d, BufTm %u ms, IntgPd %u ms\n", SimReports_getGroupingName(reportsConfig.grouping), reportsConfig.dataSetSize,
+            reportsConfig.buffered ? "BRCB" : "", (reportsConfig.buffered && reportsConfig.unbuffered) ? "/" : "", reportsConfig.unbuffered ? "URCB" : "",
+            reportsConfig.instances, reportsConfig.bufferTime, reportsConfig.integrityPeriod);
+    if (report_buffer_size_urcb > 0)
+        printf("   Report buffer size        : BRCB %d B, URCB %d B (retention %u s)\n", report_buffer_size, report_buffer_size_urcb, reportBufferRetention);
+    else
+        printf("   Report buffer size        : BRCB %d B, URCB default (retention %u s)\n", report_buffer_size, reportBufferRetention);
+    if (goose_datasets != NULL)
+        printf("   GOOSE publishing          : %s on %s%s, T1 %u ms, T0 %u ms\n", goose_datasets, gooseConfig.interface,
+            gooseConfig.vlan ? " (VLAN tagged)" : "", gooseConfig.minTime, gooseConfig.maxTime);
+    if (sv_publish)
+        printf("   Sampled Values            : %s on %s%s, %d samples/s (%d Hz x %d), %d ASDU(s) per frame%s\n", svConfig.svId, svConfig.interface,
+            svConfig.vlan ? " (VLAN tagged)" : "", svConfig.frequency * svConfig.samplesPerCycle, svConfig.frequency, svConfig.samplesPerCycle,
+            svConfig.asdus, (svConfig.harmonicsCount > 0) ? ", harmonics" : "");
+    printf("   Coefficients reload       : %s\n", coefficients_reload?"true":"false");
+    printf("   Model cache               : %s\n", modelCacheDirectory ? modelCacheDirectory : "disabled");
+    printf("   IEC61850 edition          : %d\n", iec_61850_edition);
+    printf("   Maximum connections       : %d\n", max_mms_connections);
+    printf("   Authentication (password) : %s\n", (auth_password==NULL)?"/":auth_password);
+    printf("   Threadless server         : %s\n", server_threadless?"true":"false");
+    printf("   Modeling log              : %s\n", log_modeling?"true":"false");
+    printf("   Simulation log            : %s\n", log_simulation?"true":"false");
+    printf("   Simulation frequancy      : %d Hz\n", simulation_frequency);
+    if (rateClassesCount > 0)
+        printf("   Simulation periods        : %s\n", getenv("SIMULATION_PERIODS"));
+    printf("   Simulation catch-up       : %s\n", SimScheduler_getPolicyName(simulation_catchup));
+    if (simulation_update_rate > 0)
+        printf("   Simulation update rate    : %d /s\n", simulation_update_rate);
+    else
+        printf("   Simulation batch size     : %d\n", simulation_batch_size);
+    printf("   Diagnostics interval      : %d min\n", log_diagnostics_interval );
+
+    // simulation kernel (SIMD where available, verified against sinf)
+    if (deterministic && strcmp(simulation_kernel, "scalar") != 0)
+    {
+        // the SIMD kernels differ from each other in the last bits - deterministic replay uses the same one everywhere
+        printf("Warning - simulation kernel '%s' replaced by 'scalar' for the deterministic replay\n", simulation_kernel);
+        simulation_kernel = "scalar";
+    }
+    if (!SimKernel_select(simulation_kernel))
+    {
+        printf("Warning - simulation kernel '%s' not supported, selecting automatically\n", simulation_kernel);
+        SimKernel_select("auto");
+    }
+    double kernelError = SimKernel_selfTest();
+    if (kernelError > 1e-5)
+    {
+        printf("Warning - simulation kernel '%s' failed the self-test (error %g), falling back to scalar\n", SimKernel_getName(), kernelError);
+        SimKernel_select("scalar");
+        kernelError = SimKernel_selfTest();
+    }
+    printf("   Simulation kernel         : %s (max. error %.1e)\n", SimKernel_getName(), kernelError);
+    printf("   Simulation PRNG           : %s\n", SimRandom_getAlgorithmName(simulation_prng));
+    if (deterministic)
+        printf("   Simulation seed           : %lu (deterministic)\n", deterministicSeed);
+    printf("   Simulation clock          : %s\n", simulation_virtual_clock ? "virtual" : "real");
+    if (simulation_duration > 0.0)
+        printf("   Simulation duration       : %g s\n", simulation_duration);
+    if (simulation_trace != NULL)
+        printf("   Simulation trace          : %s\n", simulation_trace);
+    if (simulation_workers > 1)
+        printf("   Simulation workers        : %d (partitioned by %s)\n", simulation_workers, simulation_partition_by_device ? "logical device" : "count");
+    printf("   Suppress unchanged values : %s\n", filterUnchanged?"true":"false");
+    if (defaultDeadband > 0.0f || defaultDeadbandRel > 0.0f)
+        printf("   Deadband (abs. / rel.)    : %g / %g\n", defaultDeadband, defaultDeadbandRel);
+
+    printf("\n");
+
+    // Server configuration
+    IedServerConfig config = IedServerConfig_create();
+    if (report_buffer_size_urcb <= 0)
+        report_buffer_size_urcb = IedServerConfig_getReportBufferSizeForURCBs(config);
+    IedServerConfig_setEdition(config, iec_61850_edition);
+    IedServerConfig_setFileServiceBasePath(config, "./vmd-filestore/");
+    IedServerConfig_enableFileService(config, false);
+    IedServerConfig_enableDynamicDataSetService(config, true);
+    IedServerConfig_enableLogService(config, false);
+    IedServerConfig_setMaxMmsConnections(config, max_mms_connections);
+
+    // the published data sets have publishers of their own
+    SimGoose goose = NULL;
+    if (goose_datasets != NULL)
+    {
+        IedServerConfig_useIntegratedGoosePublisher(config, false);
+        goose = SimGoose_create(&gooseConfig);
+    }
+
+    unsigned long reportBuffersSize = 0;
+
+    for (int k = 0; k < instancesCount; k++)
+    {
+        if (instances[k].brcbBufferSize <= 0) instances[k].brcbBufferSize = report_buffer_size;
+        if (instances[k].urcbBufferSize <= 0) instances[k].urcbBufferSize = report_buffer_size_urcb;
+
+        printf("Starting server %s (port %d)... ", instances[k].name, instances[k].port);
+        if (!startInstance(&instances[k], config, server_threadless))
+        {
+            for (int l = 0; l < k; l++)
+                stopInstance(&instances[l], server_threadless);
+            exit(-1);
+        }
+        if (goose != NULL)
+        {
+            int published = SimGoose_add(goose, k, instances[k].iedModel, goose_datasets);
+            if (published > 0)
+                printf("%d GOOSE data set(s)... ", published);
+        }
+        printf("Done!\n");
+
+        reportBuffersSize += (unsigned long) SimBuffers_getReportCount(instances[k].buffers, true) * instances[k].brcbBufferSize +
+            (unsigned long) SimBuffers_getReportCount(instances[k].buffers, false) * instances[k].urcbBufferSize;
+    }
+    printf("\n");
+    IedServerConfig_destroy(config);
+
+    if (reportBuffersSize > 0)
+        printf("Report buffers - %lu kB in total\n\n", reportBuffersSize / 1024);
+
+    if (goose_datasets != NULL && (goose == NULL || !SimGoose_start(goose)))
+        printf("Warning - GOOSE can not be published\n\n");
+
+    // sampled values run on a thread of their own, next to the simulation ticks
+    SimSv sv = NULL;
+    if (sv_publish)
+    {
+        printf("Starting Sampled Values publisher %s (%s)... ", svConfig.svId, svConfig.interface);
+        sv = SimSv_create(&svConfig);
+        if (sv != NULL && SimSv_start(sv))
+            printf("Done! (%d samples/s)\n\n", SimSv_getSampleRate(sv));
+        else
+        {
+            printf("Failed! (Sampled Values are not published)\n\n");
+            SimSv_destroy(sv);
+            sv = NULL;
+        }
+    }
+
+    for (int t = 0; t < modelTemplatesCount; t++)
+    {
+        int shared = 0;
+        for (int k = 0; k < instancesCount; k++)
+            if (instances[k].modelTemplate == modelTemplates[t]) shared++;
+
+        printf("Model %s - shared by %d instance(s), %lu kB per instance\n", SimModelTemplate_getFilename(modelTemplates[t]),
+            shared, (unsigned long) SimModelTemplate_getInstanceSize(modelTemplates[t]) / 1024);
+    }
+    if (modelTemplatesCount > 0)
+        printf("\n");
+
+    running = 1;
+    signal(SIGINT, sigint_handler);
+
+    // data point table - new rows start with default (NAN) coefficients
+    dataPointsCount = 0;
+    if (!reserveDataPoints(1))
+    {
+        printf("Error - cannot allocate the data point table. Terminating...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // runtime prepare
+    printf("Browsing the model & preparing runtime... ");
+
+    if (log_modeling) printf("\n");
+
+    for (int k = 0; k < instancesCount; k++)
+    {
+        instances[k].first = dataPointsCount;
+        browseInstance(&instances[k], log_modeling);
+        instances[k].end = dataPointsCount;
+
+        if (instances[k].buffers != NULL && !SimBuffers_bind(instances[k].buffers, dataPointsValues + instances[k].first, instances[k].end - instances[k].first))
+        {
+            printf("Warning - report buffers of %s can not be estimated (out of memory)\n", instances[k].name);
+            SimBuffers_destroy(instances[k].buffers);
+            instances[k].buffers = NULL;
+        }
+
+        CoefficientSet table = tableCoefficients();
+        loadCoefficients(&instances[k], &table);
+    }
+
+    // only the memory the model needs
+    resizeDataPoints(dataPointsCount);
+    printf("Done! (%d data points, %lu kB)\n\n", dataPointsCount, (unsigned long) (dataPointsCapacity * dataPointsRowSize / 1024));
+    
+    for (int k = 0; k < instancesCount; k++)
+        saveCoefficients(&instances[k]);
+
+    // changed configurations are reloaded while the simulation runs
+    SimWatcher watcher = NULL;
+    if (coefficients_reload)
+    {
+        watcher = SimWatcher_create(reloadCoefficients, NULL);
+
+        for (int k = 0; k < instancesCount && watcher != NULL; k++)
+        {
+            if (instances[k].config[0] == 0) continue;
+
+            int file = SimWatcher_add(watcher, instances[k].config);
+            if (file >= 0)
+                watchedInstances[file] = k;
+            else
+                printf("Warning - %s can not be watched, it is not reloaded\n", instances[k].config);
+        }
+
+        if (watcher == NULL || !createReloadSet() || !SimWatcher_start(watcher))
+            printf("Warning - coefficients can not be reloaded\n");
+    }
+
+    // runtime
+    printf("Starting simulation...\n");
+
+    double t = 0.0;
+
+    SimScheduler scheduler = SimScheduler_create(1000000000ULL / simulation_frequency, simulation_catchup);
+    SimScheduler_setVirtualClock(scheduler, simulation_virtual_clock);
+    if (server_threadless)
+        SimScheduler_setIdleHandler(scheduler, serverIdleHandler, NULL);
+
+    uint64_t durationTicks = (uint64_t)(simulation_duration * simulation_frequency);
+
+    if (simulation_trace != NULL)
+    {
+        traceFile = fopen(simulation_trace, "w");
+        if (traceFile == NULL)
+            printf("Warning - cannot open simulation trace '%s'\n", simulation_trace);
+        else
+            setvbuf(traceFile, NULL, _IOFBF, 1 << 20);
+    }
+
+    double batchBudget = 0.0;
+    int batchCursor = 0;
+
+    // scheduled mode - points with an update period are fired by the timing wheels (resolution of one tick)
+    bool scheduled = false;
+    for (int i = 0; i < dataPointsCount && !scheduled; i++)
+        scheduled = (dataPointsPeriod[i] > 0);
+
+    createPartitions(simulation_workers, simulation_partition_by_device, scheduled, SimScheduler_getTickIndex(scheduler));
+    SimWorkers workers = SimWorkers_create(partitionsCount, simulatePartition, NULL);
+
+    tickJob.mode = scheduled ? SIM_MODE_SCHEDULED : (simulation_batch_size == 1 && simulation_update_rate == 0) ? SIM_MODE_LEGACY : SIM_MODE_BATCH;
+    tickJob.frequency = simulation_frequency;
+    tickJob.log = log_simulation;
+
+    // points without a period keep the rate of the batch over all points (SIMULATION_BATCH_SIZE, SIMULATION_UPDATE_RATE)
+    double batchPerTick = (simulation_update_rate > 0) ? (double) simulation_update_rate / simulation_frequency : simulation_batch_size;
+    tickJob.defaultPeriod = (uint64_t) ceil(dataPointsCount / batchPerTick);
+    if (tickJob.defaultPeriod < 1) tickJob.defaultPeriod = 1;
+
+    if (scheduled)
+    {
+        int scheduledCount = 0;
+
+        for (int w = 0; w < partitionsCount; w++)
+        {
+            for (int i = partitions[w].first; i < partitions[w].end; i++)
+            {
+                // spread the first updates over one period
+                SimWheel_schedule(partitions[w].wheel, i - partitions[w].first, SimScheduler_getTickIndex(scheduler) + 1 + SimRandom_range(SimRandom_thread(), getPeriodTicks(i)));
+                if (dataPointsPeriod[i] > 0) scheduledCount++;
+            }
+        }
+        printf("Scheduled mode - %d of %d data points with individual update periods, the others every %lu ticks\n", scheduledCount, dataPointsCount, tickJob.defaultPeriod);
+    }
+
+    if (partitionsCount > 1)
+    {
+        for (int w = 0; w < partitionsCount; w++)
+            printf("Worker %d - data points %d..%d\n", w, partitions[w].first, partitions[w].end - 1);
+    }
+
+    uint64_t timestamp_ = Hal_getTimeInMs();
+
+    while (running) {
+        uint32_t periods = SimScheduler_waitNextTick(scheduler);
+
+        uint64_t tick = SimScheduler_getTickIndex(scheduler);
+        if (durationTicks > 0 && tick >= durationTicks)
+            break;
+
+        uint64_t timestamp = SimScheduler_getTickTime(scheduler) / 1000000;
+        traceOffsetNs = SimScheduler_getTickTime(scheduler) - SimScheduler_getStartTime(scheduler);
+
+        t = (double) SimScheduler_getTickIndex(scheduler) / simulation_frequency;
+
+        Timestamp iecTimestamp;
+        Timestamp_clearFlags(&iecTimestamp);
+        Timestamp_setTimeInMilliseconds(&iecTimestamp, timestamp);
+        Timestamp_setLeapSecondKnown(&iecTimestamp, true);
+
+        Quality iecQuality = QUALITY_VALIDITY_GOOD;
+
+        /* toggle clock-not-synchronized flag in timestamp */
+        if (((int) t % 2) == 0)
+            Timestamp_setClockNotSynchronized(&iecTimestamp, true);
+
+        // number of points to update in this tick
+        int batch = simulation_batch_size * periods;
+        if (simulation_update_rate > 0)
+        {
+            batchBudget += (double) simulation_update_rate * periods / simulation_frequency;
+            batch = (int) batchBudget;
+            batchBudget -= batch;
+        }
+        if (batch > dataPointsCount) batch = dataPointsCount;
+
+        // coefficients reloaded in the background
+        if (__atomic_load_n(&pendingCoefficients, __ATOMIC_RELAXED) != NULL)
+        {
+            CoefficientSet* reloaded = __atomic_exchange_n(&pendingCoefficients, NULL, __ATOMIC_ACQUIRE);
+            swapCoefficients(reloaded);
+            __atomic_store_n(&spareCoefficients, reloaded, __ATOMIC_RELEASE);
+        }
+
+        // phase one - the workers evaluate and stage their partitions in parallel, without holding the data model lock
+        tickJob.tick = tick;
+        tickJob.t = t;
+        tickJob.batch = batch;
+        tickJob.cursor = batchCursor;
+        if (dataPointsCount > 0) batchCursor = (int)((batchCursor + (int64_t) batch) % dataPointsCount);
+
+        SimWorkers_run(workers);
+
+        for (int k = 0; k < instancesCount; k++)
+            if (instances[k].buffers != NULL) SimBuffers_tick(instances[k].buffers, timestamp);
+
+        // phase two - push the staged values of all partitions, under a single lock per instance
+        uint64_t committed = Hal_getTimeInNs();
+        commitStagedUpdates(&iecTimestamp, iecQuality);
+
+        // changed data sets are published at once, the retransmissions follow in the background
+        for (int k = 0; k < instancesCount; k++)
+        {
+            if (!SimGoose_isPublishing(goose, k)) continue;
+
+            lockInstance(&instances[k]);
+            SimGoose_publishChanges(goose, k, committed);
+            unlockInstance(&instances[k]);
+        }
+
+        for (int w = 0; w < partitionsCount; w++)
+        {
+            if (traceFile != NULL)
+                for (int n = 0; n < partitions[w].stagedCount; n++)
+                    fprintf(traceFile, "%lu %d %.9g\n", traceOffsetNs, partitions[w].staged[n].point, partitions[w].staged[n].simulated);
+
+            partitions[w].stagedCount = 0;
+        }
+
+        if (((timestamp/1000) % (60 * log_diagnostics_interval)) == 0 && timestamp-timestamp_ > 1000) // every 15 minutes
+        {
+            printf(" [%ld] total simulated / read (last %d s) - %.1f/s / %.1f/s\n", timestamp / 1000, (int)(timestamp-timestamp_) / 1000, 1000.0f * writeCounter / (timestamp-timestamp_), 1000.0f * readCounter / (timestamp-timestamp_));
+            uint64_t suppressed = 0;
+            for (int w = 0; w < partitionsCount; w++)
+                suppressed += partitions[w].suppressed;
+            if (suppressed > 0)
+                printf(" [%ld] suppressed by change filter - %.1f/s\n", timestamp / 1000, 1000.0f * suppressed / (timestamp-timestamp_));
+
+            for (int w = 0; w < partitionsCount && partitionsCount > 1; w++)
+                printf(" [%ld] worker %d - simulated %.1f/s, busy %.1f%%\n", timestamp / 1000, w,
+                    1000.0f * partitions[w].updates / (timestamp-timestamp_), partitions[w].busyNs / 10000.0 / (timestamp-timestamp_));
+
+            for (int w = 0; w < partitionsCount; w++)
+            {
+                partitions[w].updates = 0;
+                partitions[w].suppressed = 0;
+                partitions[w].busyNs = 0;
+            }
+
+            SimSchedulerStatistics stats;
+            SimScheduler_getStatistics(scheduler, &stats);
+            printf(" [%ld] ticks %lu, overruns %lu, skipped %lu, coalesced %lu, jitter min/avg/max/sd %.1f/%.1f/%.1f/%.1f us\n", timestamp / 1000,
+                stats.ticks, stats.overruns, stats.skipped, stats.coalesced,
+                stats.jitterMinNs / 1000.0, stats.jitterMeanNs / 1000.0, stats.jitterMaxNs / 1000.0, stats.jitterStdDevNs / 1000.0);
+
+            if (lockStatistics.count > 0)
+                printf(" [%ld] data model lock - commits %lu, wait avg %.1f us, hold avg/max %.1f/%.1f us\n", timestamp / 1000, lockStatistics.count,
+                    lockStatistics.waitSum / 1000.0 / lockStatistics.count, lockStatistics.holdSum / 1000.0 / lockStatistics.count, lockStatistics.holdMax / 1000.0);
+            memset(&lockStatistics, 0, sizeof(lockStatistics));
+
+            for (int k = 0; k < instancesCount; k++)
+            {
+                if (instances[k].buffers == NULL) continue;
+
+                SimBuffersStatistics classes[2];
+                SimBuffers_getStatistics(instances[k].buffers, &classes[0], &classes[1]);
+
+                for (int c = 0; c < 2; c++)
+                {
+                    if (classes[c].modeled == 0) continue;
+
+                    printf(" [%ld] %s %s buffers - %d x %d kB, fullest %s %.1f%%, entries %.1f/s, overflows %lu, suggested %d kB\n", timestamp / 1000,
+                        instances[k].name, (c == 0) ? "BRCB" : "URCB", classes[c].count, classes[c].bufferSize / 1024,
+                        (classes[c].fullest != NULL) ? classes[c].fullest : "-", 100.0 * classes[c].occupancy,
+                        1000.0f * classes[c].entries / (timestamp-timestamp_), classes[c].overflows, classes[c].suggestedSize / 1024);
+                }
+            }
+
+            if (goose != NULL)
+            {
+                SimGooseStatistics gooseStats;
+                SimGoose_getStatistics(goose, &gooseStats);
+                if (gooseStats.publishers > 0)
+                    printf(" [%ld] GOOSE - %d data sets, events %.1f/s, retransmissions %.1f/s, latency min/avg/max %.1f/%.1f/%.1f us, errors %lu\n", timestamp / 1000,
+                        gooseStats.publishers, 1000.0f * gooseStats.events / (timestamp-timestamp_), 1000.0f * gooseStats.retransmissions / (timestamp-timestamp_),
+                        gooseStats.latencyMinNs / 1000.0, gooseStats.latencyMeanNs / 1000.0, gooseStats.latencyMaxNs / 1000.0, gooseStats.errors);
+            }
+
+            if (sv != NULL)
+            {
+                SimSvStatistics svStats;
+                SimSv_getStatistics(sv, &svStats);
+                printf(" [%ld] SV - %.1f samples/s (%lu frames), skipped %lu, inter-frame jitter min/avg/max/sd %.1f/%.1f/%.1f/%.1f us%s\n", timestamp / 1000,
+                    svStats.rate, svStats.frames, svStats.skipped, svStats.jitterMinNs / 1000.0, svStats.jitterMeanNs / 1000.0,
+                    svStats.jitterMaxNs / 1000.0, svStats.jitterStdDevNs / 1000.0, svStats.realtime ? "" : " (no real-time priority)");
+            }
+
+            timestamp_ = timestamp;
+            writeCounter = 0;
+            readCounter = 0;
+        }
+    }
+
+    SimWatcher_destroy(watcher);
+    SimGoose_destroy(goose);
+    SimSv_destroy(sv);
+    SimWorkers_destroy(workers);
+    destroyPartitions();
+    SimScheduler_destroy(scheduler);
+
+    if (traceFile != NULL)
+        fclose(traceFile);
+
+    printf("Stopped!\n\n");
+
+    for (int k = 0; k < instancesCount; k++)
+        stopInstance(&instances[k], server_threadless);
+
+    for (int t = 0; t < modelTemplatesCount; t++)
+        SimModelTemplate_destroy(modelTemplates[t]);
+
+    free(instances);
+    xmlCleanupParser();
+}
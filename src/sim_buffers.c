@@ -0,0 +1,540 @@
+#include "sim_buffers.h"
+#include "sim_datasets.h"
+#include <stdlib.h>
+#include <string.h>
+
+// sliding window of a control block in buckets of window / BUCKETS
+#define BUCKETS 60
+
+// window of the unbuffered control blocks [ms] - their entries only wait for the connection to send them
+#define URCB_WINDOW 1000
+
+// entry header in the buffer of the library (entry ID, time of entry, length, links), entries are 8 byte aligned
+#define ENTRY_OVERHEAD 48
+
+#define TRIGGERS (TRG_OPT_DATA_CHANGED | TRG_OPT_DATA_UPDATE)
+
+typedef struct
+{
+    ModelNode* node;
+    FunctionalConstraint fc;
+    int dataSet;
+    int member;
+} Member;
+
+typedef struct
+{
+    int dataSet;
+    int member;
+} Target;
+
+typedef struct
+{
+    DataSet* dataSet;
+    int memberCount;
+    int* memberSizes;           // BER encoded value [bytes]
+    int fullSize;               // all members
+    int* reports;               // control blocks of the data set
+    int reportCount;
+} BufferedDataSet;
+
+typedef struct
+{
+    ReportControlBlock* rcb;
+    int dataSet;                // -1 - not resolved, not modeled
+    uint32_t capacity;
+    uint32_t width;             // of a bucket [ms]
+
+    // entry being buffered (BufTm)
+    bool open;
+    uint64_t deadline;
+    uint8_t* included;          // per member
+    int* pending;               // included members
+    int pendingCount;
+    uint32_t pendingBytes;
+
+    uint64_t nextIntegrity;     // 0 - not started
+
+    uint32_t buckets[BUCKETS];
+    uint64_t slot;              // current bucket (time / width)
+    uint64_t windowBytes;
+    uint64_t peakBytes;         // since the last statistics
+    uint64_t maxBytes;          // since the start
+    uint32_t maxEntry;
+    uint64_t entries;
+    uint64_t overflows;
+} BufferedReport;
+
+struct sSimBuffers
+{
+    IedModel* model;
+    int bufferSize;
+    int bufferSizeURCBs;
+    uint64_t now;
+
+    BufferedDataSet* dataSets;
+    int dataSetCount;
+    BufferedReport* reports;
+    int reportCount;
+
+    Member* members;            // sorted by node
+    int memberCount;
+
+    // data point -> members of data sets, CSR
+    int pointCount;
+    int* targetsOffset;
+    Target* targets;
+    uint8_t* triggers;          // trigger options of the value attribute
+};
+
+static int berSize(int content)
+{
+    return 1 + ((content < 128) ? 1 : (content < 256) ? 2 : 3) + content;
+}
+
+// content of a BER encoded value (strings - their maximum length)
+static int valueSize(DataAttributeType type)
+{
+    switch (type)
+    {
+        case IEC61850_BOOLEAN:
+        case IEC61850_INT8: return 1;
+        case IEC61850_INT16:
+        case IEC61850_INT8U:
+        case IEC61850_ENUMERATED:
+        case IEC61850_CHECK:
+        case IEC61850_CODEDENUM:
+        case IEC61850_TRGOPS: return 2;
+        case IEC61850_INT16U:
+        case IEC61850_QUALITY:
+        case IEC61850_OPTFLDS:
+        case IEC61850_CURRENCY: return 3;
+        case IEC61850_INT24U: return 4;
+        case IEC61850_INT32:
+        case IEC61850_INT32U:
+        case IEC61850_FLOAT32: return 5;
+        case IEC61850_OCTET_STRING_6:
+        case IEC61850_ENTRY_TIME: return 6;
+        case IEC61850_OCTET_STRING_8:
+        case IEC61850_TIMESTAMP: return 8;
+        case IEC61850_INT64:
+        case IEC61850_FLOAT64: return 9;
+        case IEC61850_INT128: return 17;
+        case IEC61850_VISIBLE_STRING_32: return 32;
+        case IEC61850_OCTET_STRING_64:
+        case IEC61850_VISIBLE_STRING_64: return 64;
+        case IEC61850_VISIBLE_STRING_65: return 65;
+        case IEC61850_VISIBLE_STRING_129: return 129;
+        case IEC61850_VISIBLE_STRING_255:
+        case IEC61850_UNICODE_STRING_255: return 255;
+        default: return 5;
+    }
+}
+
+// encoded size of the data of a functional constraint under a node, 0 - none
+static int encodedSize(ModelNode* node, FunctionalConstraint fc)
+{
+    int content = 0;
+    int elements = 0;
+
+    if (node->modelType == DataAttributeModelType)
+    {
+        DataAttribute* attribute = (DataAttribute*) node;
+
+        if (attribute->fc != fc) return 0;
+        if (node->firstChild == NULL) content = valueSize(attribute->type);
+        elements = attribute->elementCount;
+    }
+    else if (node->modelType == DataObjectModelType)
+        elements = ((DataObject*) node)->elementCount;
+
+    for (ModelNode* child = node->firstChild; child != NULL; child = child->sibling)
+        content += encodedSize(child, fc);
+
+    if (content == 0) return 0;
+
+    return (elements > 0) ? berSize(elements * berSize(content)) : berSize(content);
+}
+
+static int addDataSet(SimBuffers self, DataSet* dataSet)
+{
+    for (int d = 0; d < self->dataSetCount; d++)
+        if (self->dataSets[d].dataSet == dataSet) return d;
+
+    BufferedDataSet* buffered = &self->dataSets[self->dataSetCount];
+    buffered->dataSet = dataSet;
+
+    int count = 0;
+    for (DataSetEntry* entry = dataSet->fcdas; entry != NULL; entry = entry->sibling)
+        count++;
+
+    buffered->memberSizes = (int*) calloc(count > 0 ? count : 1, sizeof(int));
+    Member* members = (Member*) realloc(self->members, (self->memberCount + count + 1) * sizeof(Member));
+    if (buffered->memberSizes == NULL || members == NULL)
+    {
+        free(buffered->memberSizes);
+        if (members != NULL) self->members = members;
+        return -1;
+    }
+    self->members = members;
+
+    for (DataSetEntry* entry = dataSet->fcdas; entry != NULL; entry = entry->sibling)
+    {
+        FunctionalConstraint fc;
+        ModelNode* node = SimDataSets_resolveEntry(self->model, entry, &fc);
+        int member = buffered->memberCount++;
+
+        if (node == NULL)
+        {
+            // not in the model, never included - still a bit of the inclusion field
+            buffered->memberSizes[member] = 0;
+            continue;
+        }
+
+        buffered->memberSizes[member] = encodedSize(node, fc) + 1;      // and the reason for inclusion
+        buffered->fullSize += buffered->memberSizes[member];
+        self->members[self->memberCount++] = (Member) { node, fc, self->dataSetCount, member };
+    }
+
+    return self->dataSetCount++;
+}
+
+static int compareMembers(const void* a, const void* b)
+{
+    uintptr_t nodeA = (uintptr_t) ((const Member*) a)->node;
+    uintptr_t nodeB = (uintptr_t) ((const Member*) b)->node;
+
+    return (nodeA > nodeB) - (nodeA < nodeB);
+}
+
+SimBuffers SimBuffers_create(IedModel* model, int bufferSize, int bufferSizeURCBs, uint32_t retention)
+{
+    SimBuffers self = (SimBuffers) calloc(1, sizeof(struct sSimBuffers));
+
+    if (self == NULL) return NULL;
+
+    self->model = model;
+    self->bufferSize = bufferSize;
+    self->bufferSizeURCBs = bufferSizeURCBs;
+
+    int count = 0;
+    for (ReportControlBlock* rcb = model->rcbs; rcb != NULL; rcb = rcb->sibling)
+        count++;
+
+    self->reports = (BufferedReport*) calloc(count > 0 ? count : 1, sizeof(BufferedReport));
+    self->dataSets = (BufferedDataSet*) calloc(count > 0 ? count : 1, sizeof(BufferedDataSet));
+
+    if (self->reports == NULL || self->dataSets == NULL)
+    {
+        SimBuffers_destroy(self);
+        return NULL;
+    }
+
+    for (ReportControlBlock* rcb = model->rcbs; rcb != NULL; rcb = rcb->sibling)
+    {
+        BufferedReport* report = &self->reports[self->reportCount++];
+        uint32_t window = rcb->buffered ? retention * 1000 : URCB_WINDOW;
+
+        report->rcb = rcb;
+        report->capacity = rcb->buffered ? bufferSize : bufferSizeURCBs;
+        report->width = (window >= BUCKETS) ? window / BUCKETS : 1;
+
+        DataSet* dataSet = SimDataSets_findForControlBlock(model, rcb->parent, rcb->dataSetName);
+        report->dataSet = (dataSet != NULL) ? addDataSet(self, dataSet) : -1;
+
+        if (report->dataSet < 0) continue;
+
+        int members = self->dataSets[report->dataSet].memberCount;
+        report->included = (uint8_t*) calloc(members > 0 ? members : 1, sizeof(uint8_t));
+        report->pending = (int*) calloc(members > 0 ? members : 1, sizeof(int));
+
+        if (report->included == NULL || report->pending == NULL)
+        {
+            SimBuffers_destroy(self);
+            return NULL;
+        }
+    }
+
+    // control blocks of each data set
+    for (int r = 0; r < self->reportCount; r++)
+        if (self->reports[r].dataSet >= 0) self->dataSets[self->reports[r].dataSet].reportCount++;
+
+    for (int d = 0; d < self->dataSetCount; d++)
+    {
+        self->dataSets[d].reports = (int*) calloc(self->dataSets[d].reportCount, sizeof(int));
+        if (self->dataSets[d].reports == NULL)
+        {
+            SimBuffers_destroy(self);
+            return NULL;
+        }
+        self->dataSets[d].reportCount = 0;
+    }
+
+    for (int r = 0; r < self->reportCount; r++)
+    {
+        if (self->reports[r].dataSet < 0) continue;
+
+        BufferedDataSet* dataSet = &self->dataSets[self->reports[r].dataSet];
+        dataSet->reports[dataSet->reportCount++] = r;
+    }
+
+    qsort(self->members, self->memberCount, sizeof(Member), compareMembers);
+
+    return self;
+}
+
+void SimBuffers_destroy(SimBuffers self)
+{
+    if (self == NULL) return;
+
+    for (int r = 0; r < self->reportCount; r++)
+    {
+        free(self->reports[r].included);
+        free(self->reports[r].pending);
+    }
+
+    for (int d = 0; d < self->dataSetCount; d++)
+    {
+        free(self->dataSets[d].memberSizes);
+        free(self->dataSets[d].reports);
+    }
+
+    free(self->reports);
+    free(self->dataSets);
+    free(self->members);
+    free(self->targetsOffset);
+    free(self->targets);
+    free(self->triggers);
+    free(self);
+}
+
+bool SimBuffers_bind(SimBuffers self, DataAttribute** values, int count)
+{
+    int capacity = 0;
+    int targetsCount = 0;
+
+    self->targetsOffset = (int*) calloc(count + 1, sizeof(int));
+    self->triggers = (uint8_t*) calloc(count > 0 ? count : 1, sizeof(uint8_t));
+
+    if (self->targetsOffset == NULL || self->triggers == NULL) return false;
+
+    for (int p = 0; p < count; p++)
+    {
+        self->targetsOffset[p] = targetsCount;
+        self->triggers[p] = values[p]->triggerOptions & TRIGGERS;
+
+        if (self->triggers[p] == 0) continue;
+
+        // the value itself or any of its parents up to the logical node can be a member
+        for (ModelNode* node = (ModelNode*) values[p]; node != NULL && node->modelType != LogicalDeviceModelType; node = node->parent)
+        {
+            int low = 0, high = self->memberCount;
+
+            while (low < high)
+            {
+                int middle = (low + high) / 2;
+                if ((uintptr_t) self->members[middle].node < (uintptr_t) node) low = middle + 1;
+                else high = middle;
+            }
+
+            for (int m = low; m < self->memberCount && self->members[m].node == node; m++)
+            {
+                if (self->members[m].fc != values[p]->fc) continue;
+
+                if (targetsCount == capacity)
+                {
+                    capacity = (capacity > 0) ? capacity * 2 : 256;
+
+                    Target* targets = (Target*) realloc(self->targets, capacity * sizeof(Target));
+                    if (targets == NULL) return false;
+                    self->targets = targets;
+                }
+
+                self->targets[targetsCount++] = (Target) { self->members[m].dataSet, self->members[m].member };
+            }
+        }
+    }
+
+    self->targetsOffset[count] = targetsCount;
+    self->pointCount = count;
+
+    // only needed for binding
+    free(self->members);
+    self->members = NULL;
+    self->memberCount = 0;
+
+    return true;
+}
+
+static void advance(BufferedReport* report, uint64_t now)
+{
+    uint64_t slot = now / report->width;
+
+    if (slot - report->slot >= BUCKETS)
+    {
+        memset(report->buckets, 0, sizeof(report->buckets));
+        report->windowBytes = 0;
+    }
+    else
+    {
+        for (uint64_t s = report->slot + 1; s <= slot; s++)
+        {
+            report->windowBytes -= report->buckets[s % BUCKETS];
+            report->buckets[s % BUCKETS] = 0;
+        }
+    }
+
+    report->slot = slot;
+}
+
+static void addEntry(BufferedReport* report, uint32_t bytes)
+{
+    bytes = (bytes + 7) & ~7u;
+
+    report->buckets[report->slot % BUCKETS] += bytes;
+    report->windowBytes += bytes;
+    report->entries++;
+
+    // the buffer can not hold the window, the entry displaces a younger one
+    if (report->windowBytes > report->capacity)
+        report->overflows++;
+
+    if (report->windowBytes > report->peakBytes) report->peakBytes = report->windowBytes;
+    if (report->windowBytes > report->maxBytes) report->maxBytes = report->windowBytes;
+    if (bytes > report->maxEntry) report->maxEntry = bytes;
+}
+
+static void closeEntry(SimBuffers self, BufferedReport* report)
+{
+    BufferedDataSet* dataSet = &self->dataSets[report->dataSet];
+
+    if (report->pendingCount > 0)
+        addEntry(report, ENTRY_OVERHEAD + (dataSet->memberCount + 7) / 8 + report->pendingBytes);
+
+    for (int n = 0; n < report->pendingCount; n++)
+        report->included[report->pending[n]] = 0;
+
+    report->pendingCount = 0;
+    report->pendingBytes = 0;
+    report->open = false;
+}
+
+void SimBuffers_tick(SimBuffers self, uint64_t now)
+{
+    self->now = now;
+
+    for (int r = 0; r < self->reportCount; r++)
+    {
+        BufferedReport* report = &self->reports[r];
+        ReportControlBlock* rcb = report->rcb;
+
+        if (report->dataSet < 0) continue;
+
+        advance(report, now);
+
+        if (report->open && now >= report->deadline)
+            closeEntry(self, report);
+
+        if (rcb->intPeriod == 0 || (rcb->trgOps & TRG_OPT_INTEGRITY) == 0) continue;
+
+        if (report->nextIntegrity == 0)
+            report->nextIntegrity = now + rcb->intPeriod;
+        else if (now >= report->nextIntegrity)
+        {
+            // all members
+            BufferedDataSet* dataSet = &self->dataSets[report->dataSet];
+            addEntry(report, ENTRY_OVERHEAD + (dataSet->memberCount + 7) / 8 + dataSet->fullSize);
+
+            report->nextIntegrity += rcb->intPeriod;
+            if (report->nextIntegrity <= now)
+                report->nextIntegrity = now + rcb->intPeriod;
+        }
+    }
+}
+
+void SimBuffers_trigger(SimBuffers self, int point)
+{
+    if (point < 0 || point >= self->pointCount) return;
+
+    uint8_t triggers = self->triggers[point];
+
+    for (int t = self->targetsOffset[point]; t < self->targetsOffset[point + 1]; t++)
+    {
+        BufferedDataSet* dataSet = &self->dataSets[self->targets[t].dataSet];
+        int member = self->targets[t].member;
+
+        for (int r = 0; r < dataSet->reportCount; r++)
+        {
+            BufferedReport* report = &self->reports[dataSet->reports[r]];
+
+            if ((report->rcb->trgOps & triggers) == 0) continue;
+
+            // a member already included is sent with the buffered entry, as the library does
+            if (report->included[member])
+                closeEntry(self, report);
+
+            report->included[member] = 1;
+            report->pending[report->pendingCount++] = member;
+            report->pendingBytes += dataSet->memberSizes[member];
+
+            if (!report->open)
+            {
+                report->open = true;
+                report->deadline = self->now + report->rcb->bufferTime;
+            }
+
+            if (report->rcb->bufferTime == 0)
+                closeEntry(self, report);
+        }
+    }
+}
+
+int SimBuffers_getReportCount(SimBuffers self, bool buffered)
+{
+    int count = 0;
+
+    for (int r = 0; self != NULL && r < self->reportCount; r++)
+        if (self->reports[r].rcb->buffered == buffered) count++;
+
+    return count;
+}
+
+void SimBuffers_getStatistics(SimBuffers self, SimBuffersStatistics* brcbs, SimBuffersStatistics* urcbs)
+{
+    memset(brcbs, 0, sizeof(SimBuffersStatistics));
+    memset(urcbs, 0, sizeof(SimBuffersStatistics));
+    brcbs->bufferSize = self->bufferSize;
+    urcbs->bufferSize = self->bufferSizeURCBs;
+
+    for (int r = 0; r < self->reportCount; r++)
+    {
+        BufferedReport* report = &self->reports[r];
+        SimBuffersStatistics* statistics = report->rcb->buffered ? brcbs : urcbs;
+
+        statistics->count++;
+        if (report->dataSet < 0) continue;
+
+        statistics->modeled++;
+        statistics->entries += report->entries;
+        statistics->overflows += report->overflows;
+
+        double occupancy = (double) report->peakBytes / report->capacity;
+        if (report->entries > 0 && (statistics->fullest == NULL || occupancy > statistics->occupancy))
+        {
+            statistics->occupancy = occupancy;
+            statistics->fullest = report->rcb->name;
+        }
+
+        // the peak with 25% headroom, at least two of the largest entries, in kB
+        uint64_t suggested = report->maxBytes + report->maxBytes / 4;
+        if (suggested < 2 * report->maxEntry) suggested = 2 * report->maxEntry;
+        suggested = (suggested + 1023) / 1024 * 1024;
+
+        if (suggested > (uint64_t) statistics->suggestedSize)
+            statistics->suggestedSize = (suggested < INT32_MAX) ? (int) suggested : INT32_MAX;
+
+        report->peakBytes = report->windowBytes;
+        report->entries = 0;
+        report->overflows = 0;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef SIM_BUFFERS_H_
+#define SIM_BUFFERS_H_
+
+#include "iec61850_model.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// estimated occupancy of the report buffers of a model - the library neither exposes its buffers nor their overflows,
+// so the report entries are modeled from the values the simulation pushes into the data sets of the control blocks
+// (BufTm coalescing, IntgPd, BER size of the included members) and accumulated over a sliding window: the retention
+// for buffered control blocks (the history a client away for that long would need), one second for unbuffered ones
+typedef struct sSimBuffers* SimBuffers;
+
+// per class of control blocks (buffered or unbuffered) since the last call of SimBuffers_getStatistics
+typedef struct
+{
+    int count;                  // control blocks of the class (all of the model, each one has a buffer)
+    int modeled;                // of them with a data set that could be resolved
+    int bufferSize;             // per control block [bytes]
+    double occupancy;           // peak window of the fullest control block relative to the buffer size, > 1 - overflow
+    const char* fullest;        // name of the fullest control block, NULL - no entries
+    uint64_t entries;           // report entries
+    uint64_t overflows;         // entries that displaced ones younger than the window
+    int suggestedSize;          // peak window (since the start) of the fullest control block with headroom [bytes]
+} SimBuffersStatistics;
+
+// retention - window of the buffered control blocks [s]
+SimBuffers SimBuffers_create(IedModel* model, int bufferSize, int bufferSizeURCBs, uint32_t retention);
+
+void SimBuffers_destroy(SimBuffers self);
+
+// data points [0, count) of the model (by their value attributes), in the order passed to SimBuffers_trigger
+bool SimBuffers_bind(SimBuffers self, DataAttribute** values, int count);
+
+// before the updates of a tick, time in ms
+void SimBuffers_tick(SimBuffers self, uint64_t now);
+
+// a data point pushed into the model
+void SimBuffers_trigger(SimBuffers self, int point);
+
+int SimBuffers_getReportCount(SimBuffers self, bool buffered);
+
+void SimBuffers_getStatistics(SimBuffers self, SimBuffersStatistics* brcbs, SimBuffersStatistics* urcbs);
+
+#endif /* SIM_BUFFERS_H_ */
@@ -0,0 +1,730 @@
+#include "sim_cache.h"
+#include "mms_value.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CACHE_FORMAT 1
+#define CACHE_MAGIC "61850SIM"
+#define HASH_SEED 0xcbf29ce484222325ULL
+
+// pointers of the image are section offsets, tagged with the section in the top bits (0 - NULL)
+#define SECTION_SHIFT (sizeof(uintptr_t) * 8 - 4)
+#define OFFSET_MASK (((uintptr_t) 1 << SECTION_SHIFT) - 1)
+#define ENCODE(section, offset) ((void*) (((uintptr_t) (section) << SECTION_SHIFT) | (uintptr_t) (offset)))
+#define AT(writer, Type, offset) ((Type*) ((writer)->sections[SECTION_IMAGE].data + (offset)))
+
+enum { SECTION_NONE, SECTION_IMAGE, SECTION_STRINGS, SECTION_VALUES, SECTIONS_COUNT };
+
+typedef struct
+{
+    char magic[8];
+    uint64_t key;                       // content of the model file, IED name and simulator version
+    uint64_t checksum;                  // of everything after the header
+    uint64_t offsets[SECTIONS_COUNT];
+    uint64_t lengths[SECTIONS_COUNT];
+} CacheHeader;
+
+struct sSimCache
+{
+    char* filename;
+    uint64_t key;
+
+    char* mapping;
+    size_t mappingLength;
+    IedModel* model;
+
+    // initial values decoded from the cache
+    MmsValue** values;
+    int valuesCount;
+    int valuesCapacity;
+};
+
+typedef struct
+{
+    char* data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+typedef struct
+{
+    Buffer sections[SECTIONS_COUNT];
+
+    // interned strings - offset + 1 in the strings section, open addressing
+    uint32_t* strings;
+    size_t stringsCapacity;
+    size_t stringsCount;
+
+    // logical nodes of the model and their offsets in the image, to link the control blocks
+    LogicalNode** nodes;
+    uintptr_t* nodeOffsets;
+    int nodesCount;
+    int nodesCapacity;
+
+    bool failed;
+} Writer;
+
+typedef struct
+{
+    SimCache cache;
+    char* base[SECTIONS_COUNT];
+    uint64_t lengths[SECTIONS_COUNT];
+    bool corrupt;
+} Reader;
+
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t length)
+{
+    const unsigned char* bytes = (const unsigned char*) data;
+
+    for (; length >= 8; bytes += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    while (length--)
+        hash = (hash ^ *bytes++) * 0x100000001b3ULL;
+
+    return hash;
+}
+
+static size_t nodeSize(ModelNode* node)
+{
+    switch (node->modelType)
+    {
+        case LogicalDeviceModelType: return sizeof(LogicalDevice);
+        case LogicalNodeModelType: return sizeof(LogicalNode);
+        case DataObjectModelType: return sizeof(DataObject);
+        default: return sizeof(DataAttribute);
+    }
+}
+
+// appends to a section (NULL data - zeroed), returns the offset of the block
+static uintptr_t append(Writer* writer, int section, const void* data, size_t length, size_t alignment)
+{
+    Buffer* buffer = &writer->sections[section];
+    size_t offset = (buffer->length + alignment - 1) & ~(alignment - 1);
+
+    if (offset + length > buffer->capacity)
+    {
+        size_t capacity = (buffer->capacity > 0) ? buffer->capacity : 4096;
+        while (capacity < offset + length) capacity *= 2;
+
+        char* grown = (char*) realloc(buffer->data, capacity);
+        if (grown == NULL)
+        {
+            writer->failed = true;
+            return 0;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+
+    memset(buffer->data + buffer->length, 0, offset - buffer->length);
+    if (data != NULL)
+        memcpy(buffer->data + offset, data, length);
+    else
+        memset(buffer->data + offset, 0, length);
+    buffer->length = offset + length;
+
+    return offset;
+}
+
+static bool growStrings(Writer* writer)
+{
+    size_t capacity = (writer->stringsCapacity > 0) ? writer->stringsCapacity * 2 : 1024;
+    uint32_t* strings = (uint32_t*) calloc(capacity, sizeof(uint32_t));
+
+    if (strings == NULL) return false;
+
+    for (size_t s = 0; s < writer->stringsCapacity; s++)
+    {
+        uint32_t entry = writer->strings[s];
+        if (entry == 0) continue;
+
+        const char* string = writer->sections[SECTION_STRINGS].data + entry - 1;
+        size_t slot = hashBytes(HASH_SEED, string, strlen(string)) & (capacity - 1);
+        while (strings[slot] != 0) slot = (slot + 1) & (capacity - 1);
+        strings[slot] = entry;
+    }
+
+    free(writer->strings);
+    writer->strings = strings;
+    writer->stringsCapacity = capacity;
+    return true;
+}
+
+static void* writeString(Writer* writer, const char* string)
+{
+    if (string == NULL) return NULL;
+
+    if (writer->stringsCount * 2 >= writer->stringsCapacity && !growStrings(writer))
+    {
+        writer->failed = true;
+        return NULL;
+    }
+
+    size_t length = strlen(string);
+    size_t mask = writer->stringsCapacity - 1;
+
+    for (size_t slot = hashBytes(HASH_SEED, string, length) & mask; ; slot = (slot + 1) & mask)
+    {
+        uint32_t entry = writer->strings[slot];
+
+        if (entry == 0)
+        {
+            uintptr_t offset = append(writer, SECTION_STRINGS, string, length + 1, 1);
+            writer->strings[slot] = (uint32_t) offset + 1;
+            writer->stringsCount++;
+            return ENCODE(SECTION_STRINGS, offset);
+        }
+
+        if (strcmp(writer->sections[SECTION_STRINGS].data + entry - 1, string) == 0)
+            return ENCODE(SECTION_STRINGS, entry - 1);
+    }
+}
+
+// value record - length and BER encoded MMS data
+static void* writeValue(Writer* writer, MmsValue* value)
+{
+    if (value == NULL) return NULL;
+
+    int length = MmsValue_encodeMmsData(value, NULL, 0, false);
+    if (length <= 0) return NULL;
+
+    uint32_t recordLength = (uint32_t) length;
+    uintptr_t offset = append(writer, SECTION_VALUES, NULL, sizeof(recordLength) + recordLength, 4);
+    if (writer->failed) return NULL;
+
+    uint8_t* record = (uint8_t*) writer->sections[SECTION_VALUES].data + offset;
+    memcpy(record, &recordLength, sizeof(recordLength));
+    MmsValue_encodeMmsData(value, record + sizeof(recordLength), 0, true);
+
+    return ENCODE(SECTION_VALUES, offset);
+}
+
+static void* writeAddress(Writer* writer, PhyComAddress* address)
+{
+    if (address == NULL) return NULL;
+
+    uintptr_t offset = append(writer, SECTION_IMAGE, address, sizeof(PhyComAddress), 8);
+    return writer->failed ? NULL : ENCODE(SECTION_IMAGE, offset);
+}
+
+static void addNode(Writer* writer, LogicalNode* node, uintptr_t offset)
+{
+    if (writer->nodesCount == writer->nodesCapacity)
+    {
+        int capacity = (writer->nodesCapacity > 0) ? writer->nodesCapacity * 2 : 64;
+        LogicalNode** nodes = (LogicalNode**) realloc(writer->nodes, capacity * sizeof(LogicalNode*));
+        uintptr_t* nodeOffsets = (uintptr_t*) realloc(writer->nodeOffsets, capacity * sizeof(uintptr_t));
+
+        if (nodes != NULL) writer->nodes = nodes;
+        if (nodeOffsets != NULL) writer->nodeOffsets = nodeOffsets;
+        if (nodes == NULL || nodeOffsets == NULL)
+        {
+            writer->failed = true;
+            return;
+        }
+        writer->nodesCapacity = capacity;
+    }
+
+    writer->nodes[writer->nodesCount] = node;
+    writer->nodeOffsets[writer->nodesCount] = offset;
+    writer->nodesCount++;
+}
+
+static LogicalNode* mapNode(Writer* writer, LogicalNode* node)
+{
+    for (int n = 0; n < writer->nodesCount; n++)
+        if (writer->nodes[n] == node)
+            return (LogicalNode*) ENCODE(SECTION_IMAGE, writer->nodeOffsets[n]);
+
+    return NULL;
+}
+
+// appends a list of sibling nodes (and their subtrees), returns the encoded pointer of the first
+static ModelNode* writeTree(Writer* writer, ModelNode* node)
+{
+    ModelNode* first = NULL;
+    uintptr_t previous = 0;
+
+    for (; node != NULL && !writer->failed; node = node->sibling)
+    {
+        size_t size = nodeSize(node);
+        uintptr_t offset = append(writer, SECTION_IMAGE, node, size, 8);
+
+        if (node->modelType == LogicalNodeModelType)
+            addNode(writer, (LogicalNode*) node, offset);
+
+        void* name = writeString(writer, node->name);
+        void* value = (node->modelType == DataAttributeModelType) ? writeValue(writer, ((DataAttribute*) node)->mmsValue) : NULL;
+        ModelNode* children = writeTree(writer, node->firstChild);
+
+        if (writer->failed) break;
+
+        // the image may have moved while appending
+        ModelNode* copy = AT(writer, ModelNode, offset);
+        copy->name = (char*) name;
+        copy->parent = NULL;
+        copy->sibling = NULL;
+        copy->firstChild = children;
+        if (node->modelType == DataAttributeModelType)
+            ((DataAttribute*) copy)->mmsValue = (MmsValue*) value;
+
+        if (previous != 0) AT(writer, ModelNode, previous)->sibling = (ModelNode*) ENCODE(SECTION_IMAGE, offset); else first = (ModelNode*) ENCODE(SECTION_IMAGE, offset);
+        previous = offset;
+    }
+
+    return first;
+}
+
+// appends a list of control blocks of the model, encoding the pointers of each copy with the given statements
+#define WRITE_CONTROL_BLOCKS(Type, field, encode) \
+    { \
+        uintptr_t previous = 0; \
+        for (Type* cb = model->field; cb != NULL && !writer.failed; cb = cb->sibling) \
+        { \
+            uintptr_t offset = append(&writer, SECTION_IMAGE, NULL, sizeof(Type), 8); \
+            Type copy = *cb; \
+            copy.parent = mapNode(&writer, cb->parent); \
+            copy.sibling = NULL; \
+            encode \
+            if (writer.failed) break; \
+            memcpy(AT(&writer, Type, offset), &copy, sizeof(Type)); \
+            if (previous != 0) AT(&writer, Type, previous)->sibling = (Type*) ENCODE(SECTION_IMAGE, offset); \
+            else AT(&writer, IedModel, 0)->field = (Type*) ENCODE(SECTION_IMAGE, offset); \
+            previous = offset; \
+        } \
+    }
+
+static void writeDataSets(Writer* writer, IedModel* model)
+{
+    uintptr_t previous = 0;
+
+    for (DataSet* dataSet = model->dataSets; dataSet != NULL && !writer->failed; dataSet = dataSet->sibling)
+    {
+        uintptr_t offset = append(writer, SECTION_IMAGE, NULL, sizeof(DataSet), 8);
+        DataSet copy = *dataSet;
+
+        copy.logicalDeviceName = (char*) writeString(writer, dataSet->logicalDeviceName);
+        copy.name = (char*) writeString(writer, dataSet->name);
+        copy.fcdas = NULL;
+        copy.sibling = NULL;
+
+        uintptr_t previousEntry = 0;
+        for (DataSetEntry* entry = dataSet->fcdas; entry != NULL && !writer->failed; entry = entry->sibling)
+        {
+            uintptr_t entryOffset = append(writer, SECTION_IMAGE, NULL, sizeof(DataSetEntry), 8);
+            DataSetEntry entryCopy = *entry;
+
+            entryCopy.logicalDeviceName = (char*) writeString(writer, entry->logicalDeviceName);
+            entryCopy.isLDNameDynamicallyAllocated = false;
+            entryCopy.variableName = (char*) writeString(writer, entry->variableName);
+            entryCopy.componentName = (char*) writeString(writer, entry->componentName);
+            entryCopy.value = NULL;
+            entryCopy.sibling = NULL;
+
+            if (writer->failed) break;
+            memcpy(AT(writer, DataSetEntry, entryOffset), &entryCopy, sizeof(DataSetEntry));
+
+            if (previousEntry != 0) AT(writer, DataSetEntry, previousEntry)->sibling = (DataSetEntry*) ENCODE(SECTION_IMAGE, entryOffset);
+            else copy.fcdas = (DataSetEntry*) ENCODE(SECTION_IMAGE, entryOffset);
+            previousEntry = entryOffset;
+        }
+
+        if (writer->failed) break;
+        memcpy(AT(writer, DataSet, offset), &copy, sizeof(DataSet));
+
+        if (previous != 0) AT(writer, DataSet, previous)->sibling = (DataSet*) ENCODE(SECTION_IMAGE, offset);
+        else AT(writer, IedModel, 0)->dataSets = (DataSet*) ENCODE(SECTION_IMAGE, offset);
+        previous = offset;
+    }
+}
+
+static void* relocate(Reader* reader, void* pointer, size_t size)
+{
+    uintptr_t value = (uintptr_t) pointer;
+
+    if (value == 0) return NULL;
+
+    uintptr_t section = value >> SECTION_SHIFT;
+    uintptr_t offset = value & OFFSET_MASK;
+
+    if (section == SECTION_NONE || section >= SECTIONS_COUNT || offset + size > reader->lengths[section])
+    {
+        reader->corrupt = true;
+        return NULL;
+    }
+
+    return reader->base[section] + offset;
+}
+
+#define RELOCATE(field, size) (field) = relocate(reader, (void*) (field), (size))
+
+static MmsValue* readValue(Reader* reader, MmsValue* pointer)
+{
+    uint8_t* record = (uint8_t*) relocate(reader, pointer, sizeof(uint32_t));
+    if (record == NULL) return NULL;
+
+    uint32_t length;
+    memcpy(&length, record, sizeof(length));
+    if (relocate(reader, pointer, sizeof(length) + length) == NULL) return NULL;
+
+    MmsValue* value = MmsValue_decodeMmsData(record + sizeof(length), 0, (int) length, NULL);
+    if (value == NULL) return NULL;
+
+    SimCache cache = reader->cache;
+    if (cache->valuesCount == cache->valuesCapacity)
+    {
+        int capacity = (cache->valuesCapacity > 0) ? cache->valuesCapacity * 2 : 256;
+        MmsValue** values = (MmsValue**) realloc(cache->values, capacity * sizeof(MmsValue*));
+        if (values == NULL)
+        {
+            MmsValue_delete(value);
+            reader->corrupt = true;
+            return NULL;
+        }
+        cache->values = values;
+        cache->valuesCapacity = capacity;
+    }
+    cache->values[cache->valuesCount++] = value;
+
+    return value;
+}
+
+static void relocateTree(Reader* reader, ModelNode* node, ModelNode* parent)
+{
+    for (; node != NULL && !reader->corrupt; node = node->sibling)
+    {
+        if (node->modelType < LogicalDeviceModelType || node->modelType > DataAttributeModelType ||
+            relocate(reader, ENCODE(SECTION_IMAGE, (char*) node - reader->base[SECTION_IMAGE]), nodeSize(node)) == NULL)
+        {
+            reader->corrupt = true;
+            return;
+        }
+
+        node->parent = parent;
+        RELOCATE(node->name, 1);
+        RELOCATE(node->firstChild, sizeof(ModelNode));
+        RELOCATE(node->sibling, sizeof(ModelNode));
+
+        if (node->modelType == DataAttributeModelType)
+            ((DataAttribute*) node)->mmsValue = readValue(reader, ((DataAttribute*) node)->mmsValue);
+
+        relocateTree(reader, node->firstChild, node);
+    }
+}
+
+#define RELOCATE_CONTROL_BLOCKS(Type, field, relocateFields) \
+    { \
+        RELOCATE(model->field, sizeof(Type)); \
+        for (Type* cb = model->field; cb != NULL && !reader->corrupt; cb = cb->sibling) \
+        { \
+            RELOCATE(cb->parent, sizeof(LogicalNode)); \
+            RELOCATE(cb->sibling, sizeof(Type)); \
+            relocateFields \
+        } \
+    }
+
+static void relocateModel(Reader* reader, IedModel* model)
+{
+    RELOCATE(model->name, 1);
+    RELOCATE(model->firstChild, sizeof(ModelNode));
+    model->initializer = NULL;
+
+    relocateTree(reader, (ModelNode*) model->firstChild, (ModelNode*) model);
+
+    RELOCATE(model->dataSets, sizeof(DataSet));
+    for (DataSet* dataSet = model->dataSets; dataSet != NULL && !reader->corrupt; dataSet = dataSet->sibling)
+    {
+        RELOCATE(dataSet->logicalDeviceName, 1);
+        RELOCATE(dataSet->name, 1);
+        RELOCATE(dataSet->sibling, sizeof(DataSet));
+        RELOCATE(dataSet->fcdas, sizeof(DataSetEntry));
+
+        for (DataSetEntry* entry = dataSet->fcdas; entry != NULL && !reader->corrupt; entry = entry->sibling)
+        {
+            RELOCATE(entry->logicalDeviceName, 1);
+            RELOCATE(entry->variableName, 1);
+            RELOCATE(entry->componentName, 1);
+            RELOCATE(entry->sibling, sizeof(DataSetEntry));
+        }
+    }
+
+    RELOCATE_CONTROL_BLOCKS(ReportControlBlock, rcbs,
+        RELOCATE(cb->name, 1); RELOCATE(cb->rptId, 1); RELOCATE(cb->dataSetName, 1);)
+    RELOCATE_CONTROL_BLOCKS(GSEControlBlock, gseCBs,
+        RELOCATE(cb->name, 1); RELOCATE(cb->appId, 1); RELOCATE(cb->dataSetName, 1); RELOCATE(cb->address, sizeof(PhyComAddress));)
+    RELOCATE_CONTROL_BLOCKS(SVControlBlock, svCBs,
+        RELOCATE(cb->name, 1); RELOCATE(cb->svId, 1); RELOCATE(cb->dataSetName, 1); RELOCATE(cb->dstAddress, sizeof(PhyComAddress));)
+    RELOCATE_CONTROL_BLOCKS(SettingGroupControlBlock, sgcbs, )
+    RELOCATE_CONTROL_BLOCKS(LogControlBlock, lcbs,
+        RELOCATE(cb->name, 1); RELOCATE(cb->dataSetName, 1); RELOCATE(cb->logRef, 1);)
+    RELOCATE_CONTROL_BLOCKS(Log, logs,
+        RELOCATE(cb->name, 1);)
+}
+
+static void releaseValues(SimCache self)
+{
+    for (int v = 0; v < self->valuesCount; v++)
+        MmsValue_delete(self->values[v]);
+
+    self->valuesCount = 0;
+}
+
+SimCache SimCache_create(const char* directory, const char* filename, const char* iedName)
+{
+    int file = open(filename, O_RDONLY);
+    if (file < 0) return NULL;
+
+    struct stat status;
+    uint64_t key = HASH_SEED;
+    bool readable = fstat(file, &status) == 0;
+
+    if (readable && status.st_size > 0)
+    {
+        void* content = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (content != MAP_FAILED)
+        {
+            key = hashBytes(key, content, (size_t) status.st_size);
+            munmap(content, (size_t) status.st_size);
+        }
+        else
+            readable = false;
+    }
+    close(file);
+
+    if (!readable) return NULL;
+
+    if (iedName == NULL) iedName = "";
+
+    // the image is only valid for the same simulator and structure layout
+    static const char version[] = SIM_VERSION;
+    const uint32_t layout[] = { CACHE_FORMAT, sizeof(void*), sizeof(IedModel), sizeof(LogicalNode), sizeof(DataObject),
+        sizeof(DataAttribute), sizeof(DataSet), sizeof(DataSetEntry), sizeof(ReportControlBlock), sizeof(GSEControlBlock),
+        sizeof(SVControlBlock), sizeof(SettingGroupControlBlock), sizeof(LogControlBlock), sizeof(Log) };
+
+    key = hashBytes(key, version, sizeof(version));
+    key = hashBytes(key, layout, sizeof(layout));
+    key = hashBytes(key, iedName, strlen(iedName) + 1);
+
+    // the name of the cache file identifies the model file and the IED, the key its content
+    char path[PATH_MAX];
+    const char* absolute = (realpath(filename, path) != NULL) ? path : filename;
+    uint64_t name = hashBytes(hashBytes(HASH_SEED, absolute, strlen(absolute) + 1), iedName, strlen(iedName) + 1);
+
+    SimCache self = (SimCache) calloc(1, sizeof(struct sSimCache));
+    size_t length = strlen(directory) + 24;
+
+    self->filename = (char*) malloc(length);
+    snprintf(self->filename, length, "%s/%016llx.model", directory, (unsigned long long) name);
+    self->key = key;
+
+    return self;
+}
+
+IedModel* SimCache_load(SimCache self)
+{
+    int file = open(self->filename, O_RDONLY);
+    if (file < 0) return NULL;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || (size_t) status.st_size < sizeof(CacheHeader))
+    {
+        close(file);
+        printf("Model cache %s is damaged - rebuilding\n", self->filename);
+        return NULL;
+    }
+
+    // private writable mapping - only the pages of the image are copied when relocated, names stay shared
+    size_t length = (size_t) status.st_size;
+    char* mapping = (char*) mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (mapping == MAP_FAILED) return NULL;
+
+    CacheHeader* header = (CacheHeader*) mapping;
+    bool valid = memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) == 0;
+
+    if (valid && header->key != self->key)
+    {
+        printf("Model cache %s is stale - rebuilding\n", self->filename);
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    Reader reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.cache = self;
+
+    for (int s = SECTION_IMAGE; valid && s < SECTIONS_COUNT; s++)
+    {
+        valid = header->offsets[s] % 8 == 0 && header->offsets[s] >= sizeof(CacheHeader) &&
+                header->offsets[s] <= length && header->lengths[s] <= length - header->offsets[s];
+        reader.base[s] = mapping + header->offsets[s];
+        reader.lengths[s] = header->lengths[s];
+    }
+
+    valid = valid && reader.lengths[SECTION_IMAGE] >= sizeof(IedModel) &&
+            header->checksum == hashBytes(HASH_SEED, mapping + sizeof(CacheHeader), length - sizeof(CacheHeader));
+
+    IedModel* model = (IedModel*) reader.base[SECTION_IMAGE];
+    if (valid)
+        relocateModel(&reader, model);
+
+    if (!valid || reader.corrupt)
+    {
+        printf("Model cache %s is damaged - rebuilding\n", self->filename);
+        releaseValues(self);
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    self->mapping = mapping;
+    self->mappingLength = length;
+    self->model = model;
+
+    return model;
+}
+
+bool SimCache_store(SimCache self, IedModel* model)
+{
+    Writer writer;
+    memset(&writer, 0, sizeof(writer));
+
+    // the model is the first block of the image
+    append(&writer, SECTION_IMAGE, NULL, sizeof(IedModel), 8);
+
+    if (!writer.failed)
+    {
+        IedModel copy = *model;
+
+        copy.name = (char*) writeString(&writer, model->name);
+        copy.firstChild = (LogicalDevice*) writeTree(&writer, (ModelNode*) model->firstChild);
+        copy.dataSets = NULL;
+        copy.rcbs = NULL;
+        copy.gseCBs = NULL;
+        copy.svCBs = NULL;
+        copy.sgcbs = NULL;
+        copy.lcbs = NULL;
+        copy.logs = NULL;
+        copy.initializer = NULL;
+
+        if (!writer.failed)
+            memcpy(AT(&writer, IedModel, 0), &copy, sizeof(IedModel));
+    }
+
+    writeDataSets(&writer, model);
+
+    WRITE_CONTROL_BLOCKS(ReportControlBlock, rcbs,
+        copy.name = (char*) writeString(&writer, cb->name);
+        copy.rptId = (char*) writeString(&writer, cb->rptId);
+        copy.dataSetName = (char*) writeString(&writer, cb->dataSetName);)
+    WRITE_CONTROL_BLOCKS(GSEControlBlock, gseCBs,
+        copy.name = (char*) writeString(&writer, cb->name);
+        copy.appId = (char*) writeString(&writer, cb->appId);
+        copy.dataSetName = (char*) writeString(&writer, cb->dataSetName);
+        copy.address = (PhyComAddress*) writeAddress(&writer, cb->address);)
+    WRITE_CONTROL_BLOCKS(SVControlBlock, svCBs,
+        copy.name = (char*) writeString(&writer, cb->name);
+        copy.svId = (char*) writeString(&writer, cb->svId);
+        copy.dataSetName = (char*) writeString(&writer, cb->dataSetName);
+        copy.dstAddress = (PhyComAddress*) writeAddress(&writer, cb->dstAddress);)
+    WRITE_CONTROL_BLOCKS(SettingGroupControlBlock, sgcbs, )
+    WRITE_CONTROL_BLOCKS(LogControlBlock, lcbs,
+        copy.name = (char*) writeString(&writer, cb->name);
+        copy.dataSetName = (char*) writeString(&writer, cb->dataSetName);
+        copy.logRef = (char*) writeString(&writer, cb->logRef);)
+    WRITE_CONTROL_BLOCKS(Log, logs,
+        copy.name = (char*) writeString(&writer, cb->name);)
+
+    // header, image, strings and values, each section aligned to 8 bytes
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.key = self->key;
+
+    size_t length = sizeof(CacheHeader);
+    for (int s = SECTION_IMAGE; s < SECTIONS_COUNT; s++)
+    {
+        header.offsets[s] = length;
+        header.lengths[s] = writer.sections[s].length;
+        length = (length + writer.sections[s].length + 7) & ~(size_t) 7;
+    }
+
+    char* content = writer.failed ? NULL : (char*) calloc(1, length);
+    bool stored = false;
+
+    if (content != NULL)
+    {
+        for (int s = SECTION_IMAGE; s < SECTIONS_COUNT; s++)
+            if (writer.sections[s].length > 0)
+                memcpy(content + header.offsets[s], writer.sections[s].data, writer.sections[s].length);
+
+        header.checksum = hashBytes(HASH_SEED, content + sizeof(CacheHeader), length - sizeof(CacheHeader));
+        memcpy(content, &header, sizeof(header));
+
+        // written next to the cache file and renamed, so a running load never sees a partial file
+        size_t temporaryLength = strlen(self->filename) + 16;
+        char* temporary = (char*) malloc(temporaryLength);
+        snprintf(temporary, temporaryLength, "%s.%d", self->filename, (int) getpid());
+
+        char* directory = strdup(self->filename);
+        char* separator = strrchr(directory, '/');
+        if (separator != NULL && separator != directory)
+        {
+            *separator = 0;
+            mkdir(directory, 0755);
+        }
+        free(directory);
+
+        FILE* file = fopen(temporary, "wb");
+        if (file != NULL)
+        {
+            stored = fwrite(content, 1, length, file) == length;
+            stored = (fclose(file) == 0) && stored;
+            stored = stored && rename(temporary, self->filename) == 0;
+            if (!stored) remove(temporary);
+        }
+
+        free(temporary);
+        free(content);
+    }
+
+    for (int s = 0; s < SECTIONS_COUNT; s++)
+        free(writer.sections[s].data);
+    free(writer.strings);
+    free(writer.nodes);
+    free(writer.nodeOffsets);
+
+    return stored;
+}
+
+const char* SimCache_getFilename(SimCache self)
+{
+    return self->filename;
+}
+
+void SimCache_destroy(SimCache self)
+{
+    if (self == NULL) return;
+
+    releaseValues(self);
+    free(self->values);
+
+    if (self->mapping != NULL)
+        munmap(self->mapping, self->mappingLength);
+
+    free(self->filename);
+    free(self);
+}
@@ -0,0 +1,30 @@
+#ifndef SIM_CACHE_H_
+#define SIM_CACHE_H_
+
+#include "iec61850_model.h"
+#include <stdbool.h>
+
+#ifndef SIM_VERSION
+#define SIM_VERSION "dev"
+#endif
+
+// binary cache of a parsed model - a relocatable image of the node tree, data sets and control blocks with
+// interned names and BER encoded initial values, in <directory>/<hash of model path and IED name>.model;
+// the cache is keyed by the content of the model file and the simulator version, a stale or damaged file
+// is detected on load and rewritten
+typedef struct sSimCache* SimCache;
+
+// NULL if the model file can not be read
+SimCache SimCache_create(const char* directory, const char* filename, const char* iedName);
+
+// the model mapped from the cache file, valid until SimCache_destroy; NULL if there is no valid cache
+IedModel* SimCache_load(SimCache self);
+
+bool SimCache_store(SimCache self, IedModel* model);
+
+const char* SimCache_getFilename(SimCache self);
+
+// releases the loaded model
+void SimCache_destroy(SimCache self);
+
+#endif /* SIM_CACHE_H_ */
@@ -0,0 +1,598 @@
+#include "sim_coefficients.h"
+#include <libxml/xmlreader.h>
+#include <libxml/xmlwriter.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define COEFFICIENTS_FORMAT 1
+#define COEFFICIENTS_MAGIC "61850COE"
+
+#define FLAG_NAMED 1
+
+// columns of the binary file, 4 bytes per data point each
+enum
+{
+    COLUMN_NAME,                        // offset + 1 in the string table, 0 - none
+    COLUMN_I,                           // -1 - none
+    COLUMN_PERIOD,
+    COLUMN_DEADBAND,
+    COLUMN_DEADBAND_RELATIVE,
+    COLUMN_TYPE,                        // index in typeNames, 0 - none
+    COLUMN_X,                           // A, B, C, D
+    COLUMN_XR = COLUMN_X + 4,           // randomness of A, B, C, D
+    COLUMNS_COUNT = COLUMN_XR + 4
+};
+
+typedef struct
+{
+    char magic[8];
+    uint32_t format;                    // also tells the byte order of the file
+    uint32_t count;
+    uint64_t key;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t stringsOffset;
+    uint64_t stringsLength;
+} CoefficientsHeader;
+
+static const char* typeNames[] =
+{
+    NULL,
+    "IEC61850_BOOLEAN",
+    "IEC61850_INT8",
+    "IEC61850_INT16",
+    "IEC61850_INT32",
+    "IEC61850_INT64",
+    "IEC61850_INT8U",
+    "IEC61850_INT16U",
+    "IEC61850_INT24/32U",
+    "IEC61850_FLOAT32",
+    "IEC61850_FLOAT64"
+};
+
+#define TYPES_COUNT ((uint32_t) (sizeof(typeNames) / sizeof(typeNames[0])))
+
+struct sSimCoefficientsReader
+{
+    SimCoefficientsFormat format;
+    bool failed;
+
+    xmlTextReaderPtr xml;
+    char* name;                         // object reference of the current data point
+    size_t nameCapacity;
+
+    char* mapping;
+    size_t mappingLength;
+    SimCoefficientsColumns columns;
+    const uint32_t* names;
+    const int32_t* indices;
+    const uint32_t* types;
+    const char* strings;
+    uint64_t stringsLength;
+    int position;
+};
+
+struct sSimCoefficientsWriter
+{
+    SimCoefficientsFormat format;
+    char* filename;
+    bool failed;
+
+    xmlTextWriterPtr xml;
+
+    // columns and string table of a binary file, written when it is completed
+    uint32_t* columns[COLUMNS_COUNT];
+    int count;
+    int capacity;
+    char* strings;
+    size_t stringsLength;
+    size_t stringsCapacity;
+    uint64_t key;
+    bool named;
+};
+
+static uint32_t lookupType(const char* type)
+{
+    for (uint32_t t = 1; type != NULL && t < TYPES_COUNT; t++)
+        if (strcmp(typeNames[t], type) == 0) return t;
+
+    return 0;
+}
+
+SimCoefficientsFormat SimCoefficients_getFormat(const char* filename)
+{
+    size_t length = strlen(filename);
+
+    return (length > 4 && strcmp(filename + length - 4, ".bin") == 0) ? SIM_COEFFICIENTS_BINARY : SIM_COEFFICIENTS_XML;
+}
+
+uint64_t SimCoefficients_addToKey(uint64_t key, const char* name)
+{
+    // FNV-1a, including the terminating zero
+    do
+        key = (key ^ (unsigned char) *name) * 0x100000001b3ULL;
+    while (*name++ != 0);
+
+    return key;
+}
+
+static void clearEntry(SimCoefficientsEntry* entry)
+{
+    entry->name = NULL;
+    entry->i = -1;
+    entry->period = 0;
+    entry->deadband = NAN;
+    entry->deadbandRelative = NAN;
+    entry->type = NULL;
+
+    for (int c = 0; c < 4; c++)
+    {
+        entry->X[c] = NAN;
+        entry->Xr[c] = NAN;
+    }
+}
+
+// XML
+
+// value of an attribute of the current element, owned by the reader - only valid until it moves on
+static const char* attribute(xmlTextReaderPtr reader, const char* name)
+{
+    if (xmlTextReaderMoveToAttribute(reader, BAD_CAST name) != 1) return NULL;
+
+    return (const char*) xmlTextReaderConstValue(reader);
+}
+
+static bool copyName(SimCoefficientsReader self, const char* name)
+{
+    size_t length = strlen(name) + 1;
+
+    if (length > self->nameCapacity)
+    {
+        char* buffer = (char*) realloc(self->name, length * 2);
+        if (buffer == NULL) return false;
+
+        self->name = buffer;
+        self->nameCapacity = length * 2;
+    }
+
+    memcpy(self->name, name, length);
+    return true;
+}
+
+static bool nextXml(SimCoefficientsReader self, SimCoefficientsEntry* entry)
+{
+    xmlTextReaderPtr reader = self->xml;
+    int status;
+
+    while ((status = xmlTextReaderRead(reader)) == 1)
+    {
+        if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT && xmlStrEqual(xmlTextReaderConstLocalName(reader), BAD_CAST "DataPoint"))
+            break;
+    }
+
+    if (status != 1)
+    {
+        self->failed |= (status != 0);
+        return false;
+    }
+
+    clearEntry(entry);
+
+    const char* value;
+    if ((value = attribute(reader, "name")) != NULL)
+    {
+        if (!copyName(self, value))
+        {
+            self->failed = true;
+            return false;
+        }
+        entry->name = self->name;
+    }
+    if ((value = attribute(reader, "i")) != NULL) entry->i = atoi(value);
+    if ((value = attribute(reader, "period")) != NULL) entry->period = atoi(value);
+    if ((value = attribute(reader, "deadband")) != NULL) entry->deadband = atof(value);
+    if ((value = attribute(reader, "deadbandRelative")) != NULL) entry->deadbandRelative = atof(value);
+    if ((value = attribute(reader, "type")) != NULL) entry->type = typeNames[lookupType(value)];
+
+    xmlTextReaderMoveToElement(reader);
+    if (xmlTextReaderIsEmptyElement(reader)) return true;
+
+    // coefficients, until the end of the data point
+    int depth = xmlTextReaderDepth(reader);
+    float* X = NULL;                    // coefficient waiting for its text
+
+    while ((status = xmlTextReaderRead(reader)) == 1)
+    {
+        int nodeType = xmlTextReaderNodeType(reader);
+
+        if (nodeType == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == depth)
+            return true;
+
+        if (nodeType == XML_READER_TYPE_TEXT && X != NULL)
+        {
+            *X = atof((const char*) xmlTextReaderConstValue(reader));
+            X = NULL;
+            continue;
+        }
+        if (nodeType != XML_READER_TYPE_ELEMENT) continue;
+
+        X = NULL;
+        if (!xmlStrEqual(xmlTextReaderConstLocalName(reader), BAD_CAST "Coefficient")) continue;
+
+        const char* name = attribute(reader, "name");
+        if (name == NULL || name[0] < 'A' || name[0] > 'D' || name[1] != 0) continue;
+
+        int c = name[0] - 'A';
+        X = &entry->X[c];
+        entry->Xr[c] = ((value = attribute(reader, "randomness")) != NULL) ? atof(value) : 0.0f;
+    }
+
+    // the data point is not closed
+    self->failed = true;
+    return false;
+}
+
+static void writeXmlCoefficient(xmlTextWriterPtr writer, char name, float X, float Xr)
+{
+    char buffer[64];
+
+    xmlTextWriterStartElement(writer, BAD_CAST "Coefficient");
+    snprintf(buffer, sizeof(buffer), "%c", name);
+    xmlTextWriterWriteAttribute(writer, BAD_CAST "name", BAD_CAST buffer);
+    snprintf(buffer, sizeof(buffer), "%0.2f", Xr);
+    xmlTextWriterWriteAttribute(writer, BAD_CAST "randomness", BAD_CAST buffer);
+    snprintf(buffer, sizeof(buffer), "%f", X);
+    xmlTextWriterWriteString(writer, BAD_CAST buffer);
+    xmlTextWriterEndElement(writer);
+}
+
+static void writeXml(SimCoefficientsWriter self, const SimCoefficientsEntry* entry)
+{
+    xmlTextWriterPtr writer = self->xml;
+    char buffer[64];
+
+    xmlTextWriterStartElement(writer, BAD_CAST "DataPoint");
+
+    if (entry->name != NULL)
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "name", BAD_CAST entry->name);
+    if (entry->i >= 0)
+    {
+        snprintf(buffer, sizeof(buffer), "%d", entry->i);
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "i", BAD_CAST buffer);
+    }
+    if (entry->period > 0)
+    {
+        snprintf(buffer, sizeof(buffer), "%u", entry->period);
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "period", BAD_CAST buffer);
+    }
+    if (!isnan(entry->deadband))
+    {
+        snprintf(buffer, sizeof(buffer), "%g", entry->deadband);
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "deadband", BAD_CAST buffer);
+    }
+    if (!isnan(entry->deadbandRelative))
+    {
+        snprintf(buffer, sizeof(buffer), "%g", entry->deadbandRelative);
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "deadbandRelative", BAD_CAST buffer);
+    }
+    if (entry->type != NULL)
+        xmlTextWriterWriteAttribute(writer, BAD_CAST "type", BAD_CAST entry->type);
+
+    for (int c = 0; c < 4; c++)
+        if (!isnan(entry->X[c]))
+            writeXmlCoefficient(writer, 'A' + c, entry->X[c], entry->Xr[c]);
+
+    if (xmlTextWriterEndElement(writer) < 0)
+        self->failed = true;
+}
+
+// binary
+
+static bool mapBinary(SimCoefficientsReader self, int fd)
+{
+    struct stat status;
+
+    if (fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(CoefficientsHeader)) return false;
+
+    self->mappingLength = status.st_size;
+    self->mapping = (char*) mmap(NULL, self->mappingLength, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (self->mapping == MAP_FAILED)
+    {
+        self->mapping = NULL;
+        return false;
+    }
+
+    CoefficientsHeader* header = (CoefficientsHeader*) self->mapping;
+    uint64_t columnsEnd = sizeof(CoefficientsHeader) + (uint64_t) COLUMNS_COUNT * 4 * header->count;
+
+    if (header->format != COEFFICIENTS_FORMAT || header->count > INT32_MAX || columnsEnd > header->stringsOffset ||
+        header->stringsOffset > self->mappingLength || header->stringsLength > self->mappingLength - header->stringsOffset ||
+        (header->stringsLength > 0 && self->mapping[header->stringsOffset + header->stringsLength - 1] != 0))
+        return false;
+
+    const uint32_t* column[COLUMNS_COUNT];
+    for (int k = 0; k < COLUMNS_COUNT; k++)
+        column[k] = (const uint32_t*) (self->mapping + sizeof(CoefficientsHeader)) + (size_t) k * header->count;
+
+    self->columns.count = header->count;
+    self->columns.key = header->key;
+    self->columns.named = (header->flags & FLAG_NAMED) != 0;
+    self->columns.period = column[COLUMN_PERIOD];
+    self->columns.deadband = (const float*) column[COLUMN_DEADBAND];
+    self->columns.deadbandRelative = (const float*) column[COLUMN_DEADBAND_RELATIVE];
+    for (int c = 0; c < 4; c++)
+    {
+        self->columns.X[c] = (const float*) column[COLUMN_X + c];
+        self->columns.Xr[c] = (const float*) column[COLUMN_XR + c];
+    }
+
+    self->names = column[COLUMN_NAME];
+    self->indices = (const int32_t*) column[COLUMN_I];
+    self->types = column[COLUMN_TYPE];
+    self->strings = self->mapping + header->stringsOffset;
+    self->stringsLength = header->stringsLength;
+
+    return true;
+}
+
+static bool nextBinary(SimCoefficientsReader self, SimCoefficientsEntry* entry)
+{
+    if (self->position >= self->columns.count) return false;
+
+    int n = self->position++;
+
+    uint32_t name = self->names[n];
+    if (name > self->stringsLength)
+    {
+        self->failed = true;
+        return false;
+    }
+
+    entry->name = (name > 0) ? self->strings + name - 1 : NULL;
+    entry->i = self->indices[n];
+    entry->period = self->columns.period[n];
+    entry->deadband = self->columns.deadband[n];
+    entry->deadbandRelative = self->columns.deadbandRelative[n];
+    entry->type = (self->types[n] < TYPES_COUNT) ? typeNames[self->types[n]] : NULL;
+
+    for (int c = 0; c < 4; c++)
+    {
+        entry->X[c] = self->columns.X[c][n];
+        entry->Xr[c] = self->columns.Xr[c][n];
+    }
+
+    return true;
+}
+
+static bool growBinary(SimCoefficientsWriter self, size_t stringLength)
+{
+    if (self->count == self->capacity)
+    {
+        int capacity = (self->capacity > 0) ? self->capacity * 2 : 1024;
+
+        for (int k = 0; k < COLUMNS_COUNT; k++)
+        {
+            uint32_t* column = (uint32_t*) realloc(self->columns[k], (size_t) capacity * sizeof(uint32_t));
+            if (column == NULL) return false;
+            self->columns[k] = column;
+        }
+        self->capacity = capacity;
+    }
+
+    if (self->stringsLength + stringLength > self->stringsCapacity)
+    {
+        size_t capacity = (self->stringsCapacity > 0) ? self->stringsCapacity : 65536;
+        while (capacity < self->stringsLength + stringLength) capacity *= 2;
+
+        char* strings = (char*) realloc(self->strings, capacity);
+        if (strings == NULL) return false;
+
+        self->strings = strings;
+        self->stringsCapacity = capacity;
+    }
+
+    return true;
+}
+
+static void writeBinary(SimCoefficientsWriter self, const SimCoefficientsEntry* entry)
+{
+    size_t nameLength = (entry->name != NULL) ? strlen(entry->name) + 1 : 0;
+
+    if (self->failed || !growBinary(self, nameLength))
+    {
+        self->failed = true;
+        return;
+    }
+
+    int n = self->count++;
+
+    if (entry->name != NULL)
+    {
+        memcpy(self->strings + self->stringsLength, entry->name, nameLength);
+        self->columns[COLUMN_NAME][n] = (uint32_t) self->stringsLength + 1;
+        self->stringsLength += nameLength;
+        self->key = SimCoefficients_addToKey(self->key, entry->name);
+    }
+    else
+    {
+        self->columns[COLUMN_NAME][n] = 0;
+        self->named = false;
+    }
+
+    self->columns[COLUMN_I][n] = (uint32_t) entry->i;
+    self->columns[COLUMN_PERIOD][n] = entry->period;
+    memcpy(&self->columns[COLUMN_DEADBAND][n], &entry->deadband, sizeof(float));
+    memcpy(&self->columns[COLUMN_DEADBAND_RELATIVE][n], &entry->deadbandRelative, sizeof(float));
+    self->columns[COLUMN_TYPE][n] = lookupType(entry->type);
+
+    for (int c = 0; c < 4; c++)
+    {
+        memcpy(&self->columns[COLUMN_X + c][n], &entry->X[c], sizeof(float));
+        memcpy(&self->columns[COLUMN_XR + c][n], &entry->Xr[c], sizeof(float));
+    }
+}
+
+static bool completeBinary(SimCoefficientsWriter self)
+{
+    if (self->failed || self->stringsLength > UINT32_MAX) return false;
+
+    CoefficientsHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COEFFICIENTS_MAGIC, sizeof(header.magic));
+    header.format = COEFFICIENTS_FORMAT;
+    header.count = self->count;
+    header.key = self->key;
+    header.flags = self->named ? FLAG_NAMED : 0;
+    header.stringsOffset = sizeof(CoefficientsHeader) + (uint64_t) COLUMNS_COUNT * 4 * self->count;
+    header.stringsLength = self->stringsLength;
+
+    FILE* file = fopen(self->filename, "wb");
+    if (file == NULL) return false;
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int k = 0; k < COLUMNS_COUNT && written && self->count > 0; k++)
+        written = fwrite(self->columns[k], sizeof(uint32_t), self->count, file) == (size_t) self->count;
+    if (written && self->stringsLength > 0)
+        written = fwrite(self->strings, 1, self->stringsLength, file) == self->stringsLength;
+
+    return (fclose(file) == 0) && written;
+}
+
+// reader
+
+SimCoefficientsReader SimCoefficientsReader_open(const char* filename)
+{
+    char magic[sizeof(((CoefficientsHeader*) 0)->magic)];
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    SimCoefficientsReader self = (SimCoefficientsReader) calloc(1, sizeof(struct sSimCoefficientsReader));
+    if (self == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    if (pread(fd, magic, sizeof(magic), 0) == sizeof(magic) && memcmp(magic, COEFFICIENTS_MAGIC, sizeof(magic)) == 0)
+    {
+        self->format = SIM_COEFFICIENTS_BINARY;
+        bool mapped = mapBinary(self, fd);
+        close(fd);
+
+        if (!mapped)
+        {
+            printf("Warning - %s is not a valid coefficients file\n", filename);
+            SimCoefficientsReader_close(self);
+            return NULL;
+        }
+        return self;
+    }
+    close(fd);
+
+    LIBXML_TEST_VERSION
+
+    self->format = SIM_COEFFICIENTS_XML;
+    self->xml = xmlReaderForFile(filename, NULL, XML_PARSE_NOBLANKS | XML_PARSE_HUGE);
+    if (self->xml == NULL)
+    {
+        free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+bool SimCoefficientsReader_next(SimCoefficientsReader self, SimCoefficientsEntry* entry)
+{
+    return (self->format == SIM_COEFFICIENTS_BINARY) ? nextBinary(self, entry) : nextXml(self, entry);
+}
+
+bool SimCoefficientsReader_hasFailed(SimCoefficientsReader self)
+{
+    return self->failed;
+}
+
+const SimCoefficientsColumns* SimCoefficientsReader_getColumns(SimCoefficientsReader self)
+{
+    return (self->format == SIM_COEFFICIENTS_BINARY) ? &self->columns : NULL;
+}
+
+void SimCoefficientsReader_close(SimCoefficientsReader self)
+{
+    if (self == NULL) return;
+
+    if (self->xml != NULL) xmlFreeTextReader(self->xml);
+    if (self->mapping != NULL) munmap(self->mapping, self->mappingLength);
+    free(self->name);
+    free(self);
+}
+
+// writer
+
+SimCoefficientsWriter SimCoefficientsWriter_create(const char* filename, SimCoefficientsFormat format)
+{
+    SimCoefficientsWriter self = (SimCoefficientsWriter) calloc(1, sizeof(struct sSimCoefficientsWriter));
+    if (self == NULL) return NULL;
+
+    self->format = format;
+    self->filename = strdup(filename);
+    self->key = SIM_COEFFICIENTS_KEY;
+    self->named = true;
+
+    if (format == SIM_COEFFICIENTS_BINARY)
+        return self;
+
+    LIBXML_TEST_VERSION
+
+    // libxml2 buffers the output of the writer
+    self->xml = xmlNewTextWriterFilename(filename, 0);
+    if (self->xml == NULL)
+    {
+        free(self->filename);
+        free(self);
+        return NULL;
+    }
+
+    xmlTextWriterSetIndent(self->xml, 1);
+    xmlTextWriterSetIndentString(self->xml, BAD_CAST "  ");
+    xmlTextWriterStartDocument(self->xml, NULL, "UTF-8", NULL);
+    xmlTextWriterStartElement(self->xml, BAD_CAST "DataPointsCoefficients");
+
+    return self;
+}
+
+void SimCoefficientsWriter_write(SimCoefficientsWriter self, const SimCoefficientsEntry* entry)
+{
+    if (self->format == SIM_COEFFICIENTS_BINARY)
+        writeBinary(self, entry);
+    else
+        writeXml(self, entry);
+}
+
+bool SimCoefficientsWriter_close(SimCoefficientsWriter self)
+{
+    bool written;
+
+    if (self->format == SIM_COEFFICIENTS_BINARY)
+        written = completeBinary(self);
+    else
+    {
+        written = (xmlTextWriterEndDocument(self->xml) >= 0) && !self->failed;
+        xmlFreeTextWriter(self->xml);
+    }
+
+    for (int k = 0; k < COLUMNS_COUNT; k++)
+        free(self->columns[k]);
+    free(self->strings);
+    free(self->filename);
+    free(self);
+
+    return written;
+}
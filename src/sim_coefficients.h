@@ -0,0 +1,76 @@
+#ifndef SIM_COEFFICIENTS_H_
+#define SIM_COEFFICIENTS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// coefficients configuration files - the XML schema (DataPointsCoefficients) or a compact binary format with the same
+// content: a header, packed columns of the data points (A/Ar ... D/Dr, period, deadbands, ...) and a string table
+// of the object references; the binary columns are mapped from the file and can be copied into the simulation as a whole
+typedef enum
+{
+    SIM_COEFFICIENTS_XML,
+    SIM_COEFFICIENTS_BINARY
+} SimCoefficientsFormat;
+
+#define SIM_COEFFICIENTS_KEY 0xcbf29ce484222325ULL
+
+// one data point of a file, NAN - coefficient not set
+typedef struct
+{
+    const char* name;               // object reference, NULL - none
+    int i;                          // index in the instance, -1 - none
+    uint32_t period;                // 0 - none
+    float deadband;                 // NAN - none
+    float deadbandRelative;         // NAN - none
+    const char* type;               // NULL - none
+    float X[4];                     // A, B, C, D
+    float Xr[4];                    // randomness of A, B, C, D
+} SimCoefficientsEntry;
+
+// columns of all data points of a binary file, in file order
+typedef struct
+{
+    int count;
+    uint64_t key;                   // of the object references in file order, see SimCoefficients_addToKey
+    bool named;                     // every data point has an object reference
+
+    const uint32_t* period;
+    const float* deadband;
+    const float* deadbandRelative;
+    const float* X[4];
+    const float* Xr[4];
+} SimCoefficientsColumns;
+
+// format of a file to be written, by its name - *.bin is binary, anything else XML
+SimCoefficientsFormat SimCoefficients_getFormat(const char* filename);
+
+// key of a sequence of object references, starting from SIM_COEFFICIENTS_KEY
+uint64_t SimCoefficients_addToKey(uint64_t key, const char* name);
+
+typedef struct sSimCoefficientsReader* SimCoefficientsReader;
+
+// the format is detected from the content; NULL if the file can not be opened (or is a damaged binary file)
+SimCoefficientsReader SimCoefficientsReader_open(const char* filename);
+
+// next data point, valid until the next call; false - end of the file or an error
+bool SimCoefficientsReader_next(SimCoefficientsReader self, SimCoefficientsEntry* entry);
+
+// the file could not be read to the end
+bool SimCoefficientsReader_hasFailed(SimCoefficientsReader self);
+
+// columns of a binary file, valid until the reader is closed; NULL - XML file
+const SimCoefficientsColumns* SimCoefficientsReader_getColumns(SimCoefficientsReader self);
+
+void SimCoefficientsReader_close(SimCoefficientsReader self);
+
+typedef struct sSimCoefficientsWriter* SimCoefficientsWriter;
+
+SimCoefficientsWriter SimCoefficientsWriter_create(const char* filename, SimCoefficientsFormat format);
+
+void SimCoefficientsWriter_write(SimCoefficientsWriter self, const SimCoefficientsEntry* entry);
+
+// completes the file and releases the writer, false - the file could not be written
+bool SimCoefficientsWriter_close(SimCoefficientsWriter self);
+
+#endif /* SIM_COEFFICIENTS_H_ */
@@ -0,0 +1,94 @@
+#include "sim_datasets.h"
+#include <stdio.h>
+#include <string.h>
+
+static bool isDevice(IedModel* model, const char* deviceName, const char* name, size_t length)
+{
+    if (strlen(deviceName) == length && strncmp(deviceName, name, length) == 0) return true;
+
+    // with the IED name
+    size_t iedLength = strlen(model->name);
+    return length > iedLength && strncmp(name, model->name, iedLength) == 0 &&
+        strlen(deviceName) == length - iedLength && strncmp(name + iedLength, deviceName, length - iedLength) == 0;
+}
+
+static DataSet* findDataSet(IedModel* model, const char* device, size_t deviceLength, const char* name)
+{
+    for (DataSet* dataSet = model->dataSets; dataSet != NULL; dataSet = dataSet->sibling)
+        if (strcmp(dataSet->name, name) == 0 && isDevice(model, dataSet->logicalDeviceName, device, deviceLength))
+            return dataSet;
+
+    return NULL;
+}
+
+DataSet* SimDataSets_find(IedModel* model, const char* reference)
+{
+    const char* slash = strchr(reference, '/');
+
+    if (slash == NULL) return NULL;
+
+    return findDataSet(model, reference, slash - reference, slash + 1);
+}
+
+DataSet* SimDataSets_findForControlBlock(IedModel* model, LogicalNode* parent, const char* dataSetName)
+{
+    if (dataSetName == NULL || parent == NULL) return NULL;
+
+    if (strchr(dataSetName, '/') != NULL)
+        return SimDataSets_find(model, dataSetName);
+
+    const char* device = parent->parent->name;
+
+    if (strchr(dataSetName, '$') != NULL)
+        return findDataSet(model, device, strlen(device), dataSetName);
+
+    char name[130];
+    snprintf(name, sizeof(name), "%s$%s", parent->name, dataSetName);
+
+    return findDataSet(model, device, strlen(device), name);
+}
+
+static ModelNode* findChild(ModelNode* node, const char* name, FunctionalConstraint fc)
+{
+    for (ModelNode* child = node->firstChild; child != NULL; child = child->sibling)
+    {
+        if (strcmp(child->name, name) != 0) continue;
+        if (child->modelType == DataAttributeModelType && ((DataAttribute*) child)->fc != fc) continue;
+
+        return child;
+    }
+
+    return NULL;
+}
+
+ModelNode* SimDataSets_resolveEntry(IedModel* model, DataSetEntry* entry, FunctionalConstraint* fc)
+{
+    if (entry->logicalDeviceName == NULL || entry->variableName == NULL) return NULL;
+
+    LogicalDevice* device = model->firstChild;
+    while (device != NULL && !isDevice(model, device->name, entry->logicalDeviceName, strlen(entry->logicalDeviceName)))
+        device = (LogicalDevice*) device->sibling;
+
+    if (device == NULL) return NULL;
+
+    char path[260];
+    if (entry->componentName != NULL)
+        snprintf(path, sizeof(path), "%s$%s", entry->variableName, entry->componentName);
+    else
+        snprintf(path, sizeof(path), "%s", entry->variableName);
+
+    char* context = NULL;
+    char* name = strtok_r(path, "$", &context);
+    char* fcName = strtok_r(NULL, "$", &context);
+
+    if (name == NULL || fcName == NULL) return NULL;
+
+    *fc = FunctionalConstraint_fromString(fcName);
+
+    ModelNode* node = findChild((ModelNode*) device, name, *fc);
+
+    while (node != NULL && (name = strtok_r(NULL, "$", &context)) != NULL)
+        node = findChild(node, name, *fc);
+
+    return node;
+}
@@ -0,0 +1,17 @@
+#ifndef SIM_DATASETS_H_
+#define SIM_DATASETS_H_
+
+#include "iec61850_model.h"
+
+// data sets of a model by reference - the logical device is its instance (with or without the IED name)
+
+// logicalDevice/LN$name
+DataSet* SimDataSets_find(IedModel* model, const char* reference);
+
+// data set of a control block - relative to its logical node (name), or LN$name, LD/LN$name
+DataSet* SimDataSets_findForControlBlock(IedModel* model, LogicalNode* parent, const char* dataSetName);
+
+// node of a data set entry (LN$FC$DO[$DA...]) and its functional constraint, NULL - not in the model
+ModelNode* SimDataSets_resolveEntry(IedModel* model, DataSetEntry* entry, FunctionalConstraint* fc);
+
+#endif /* SIM_DATASETS_H_ */
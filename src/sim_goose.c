@@ -0,0 +1,461 @@
+#define _GNU_SOURCE
+#include "sim_goose.h"
+#include "sim_datasets.h"
+#include "goose_publisher.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+#include "linked_list.h"
+#include "mms_value.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// trigger options of the attributes whose changes are events
+#define EVENT_TRIGGERS (TRG_OPT_DATA_CHANGED | TRG_OPT_QUALITY_CHANGED | TRG_OPT_DATA_UPDATE)
+
+typedef struct
+{
+    DataAttribute* attribute;   // in the model
+    MmsValue* value;            // in the published copy
+    bool triggered;             // a change is an event, others are just carried along
+} Leaf;
+
+typedef struct
+{
+    int owner;
+    GoosePublisher publisher;
+    char goCbRef[130];
+    char dataSetRef[130];
+    char goId[130];
+
+    LinkedList values;          // copy of the members, as published
+    Leaf* leaves;
+    int leafCount;
+
+    Semaphore lock;             // publisher, copy and schedule - shared by the simulation and the thread
+    uint32_t minTime;           // T1 [ms]
+    uint32_t maxTime;           // T0 [ms]
+    uint32_t interval;          // to the next frame [ms]
+    uint64_t next;              // next retransmission [ns]
+} Stream;
+
+struct sSimGoose
+{
+    SimGooseConfig config;
+    char interface[64];
+
+    Stream* streams;
+    int count;
+
+    int wakeup[2];              // pipe to reschedule the thread after an event, closed to stop it
+    Thread thread;
+
+    // statistics - counters shared with the thread, latency of the simulation only
+    uint64_t events;
+    uint64_t retransmissions;
+    uint64_t errors;
+    uint64_t latencySum;
+    uint64_t latencyMin;
+    uint64_t latencyMax;
+};
+
+static bool addLeaf(Stream* stream, DataAttribute* attribute, MmsValue* value)
+{
+    Leaf* leaves = (Leaf*) realloc(stream->leaves, (stream->leafCount + 1) * sizeof(Leaf));
+
+    if (leaves == NULL) return false;
+    stream->leaves = leaves;
+
+    Leaf* leaf = &stream->leaves[stream->leafCount++];
+    leaf->attribute = attribute;
+    leaf->value = value;
+    leaf->triggered = (attribute->triggerOptions & EVENT_TRIGGERS) != 0;
+
+    return true;
+}
+
+// copy of a data set member - a basic value, or a structure of the children with the functional constraint
+static MmsValue* copyMember(Stream* stream, ModelNode* node, FunctionalConstraint fc)
+{
+    if (node->modelType == DataAttributeModelType)
+    {
+        DataAttribute* attribute = (DataAttribute*) node;
+
+        if (attribute->fc != fc) return NULL;
+
+        if (node->firstChild == NULL || attribute->elementCount > 0)
+        {
+            if (attribute->mmsValue == NULL) return NULL;
+
+            MmsValue* value = MmsValue_clone(attribute->mmsValue);
+
+            if (value != NULL && !addLeaf(stream, attribute, value))
+            {
+                MmsValue_delete(value);
+                return NULL;
+            }
+
+            return value;
+        }
+    }
+
+    int count = 0;
+    for (ModelNode* child = node->firstChild; child != NULL; child = child->sibling)
+        count++;
+
+    MmsValue** elements = (MmsValue**) calloc(count > 0 ? count : 1, sizeof(MmsValue*));
+
+    if (elements == NULL) return NULL;
+
+    int copied = 0;
+    for (ModelNode* child = node->firstChild; child != NULL; child = child->sibling)
+    {
+        MmsValue* element = copyMember(stream, child, fc);
+        if (element != NULL) elements[copied++] = element;
+    }
+
+    MmsValue* structure = (copied > 0) ? MmsValue_createEmptyStructure(copied) : NULL;
+
+    for (int e = 0; e < copied; e++)
+    {
+        if (structure != NULL)
+            MmsValue_setElement(structure, e, elements[e]);
+        else
+            MmsValue_delete(elements[e]);
+    }
+
+    free(elements);
+    return structure;
+}
+
+static void releaseStream(Stream* stream)
+{
+    if (stream->publisher != NULL) GoosePublisher_destroy(stream->publisher);
+    if (stream->values != NULL) LinkedList_destroyDeep(stream->values, (LinkedListValueDeleteFunction) MmsValue_delete);
+    if (stream->lock != NULL) Semaphore_destroy(stream->lock);
+    free(stream->leaves);
+}
+
+static GSEControlBlock* findControlBlock(IedModel* model, DataSet* dataSet)
+{
+    for (GSEControlBlock* controlBlock = model->gseCBs; controlBlock != NULL; controlBlock = controlBlock->sibling)
+        if (SimDataSets_findForControlBlock(model, controlBlock->parent, controlBlock->dataSetName) == dataSet)
+            return controlBlock;
+
+    return NULL;
+}
+
+static bool createStream(SimGoose self, Stream* stream, int owner, IedModel* model, DataSet* dataSet)
+{
+    memset(stream, 0, sizeof(Stream));
+    stream->owner = owner;
+
+    // the control block of the data set in the model if there is one, otherwise one named after the data set
+    GSEControlBlock* controlBlock = findControlBlock(model, dataSet);
+
+    const char* dollar = strchr(dataSet->name, '$');
+    int nodeLength = (dollar != NULL) ? (int) (dollar - dataSet->name) : (int) strlen(dataSet->name);
+
+    if (controlBlock != NULL)
+        snprintf(stream->goCbRef, sizeof(stream->goCbRef), "%s%s/%s$GO$%s", model->name,
+            controlBlock->parent->parent->name, controlBlock->parent->name, controlBlock->name);
+    else
+        snprintf(stream->goCbRef, sizeof(stream->goCbRef), "%s%s/%.*s$GO$gcb%s", model->name,
+            dataSet->logicalDeviceName, nodeLength, dataSet->name, (dollar != NULL) ? dollar + 1 : dataSet->name);
+
+    snprintf(stream->dataSetRef, sizeof(stream->dataSetRef), "%s%s/%s", model->name, dataSet->logicalDeviceName, dataSet->name);
+    snprintf(stream->goId, sizeof(stream->goId), "%s", (controlBlock != NULL && controlBlock->appId != NULL &&
+        controlBlock->appId[0] != 0) ? controlBlock->appId : stream->goCbRef);
+
+    CommParameters parameters;
+
+    if (controlBlock != NULL && controlBlock->address != NULL)
+    {
+        parameters.vlanPriority = controlBlock->address->vlanPriority;
+        parameters.vlanId = controlBlock->address->vlanId;
+        parameters.appId = controlBlock->address->appId;
+        memcpy(parameters.dstAddress, controlBlock->address->dstAddress, 6);
+    }
+    else
+    {
+        parameters.vlanPriority = self->config.vlanPriority;
+        parameters.vlanId = self->config.vlanId;
+        parameters.appId = self->config.appId + self->count;
+        memcpy(parameters.dstAddress, self->config.dstAddress, 6);
+        parameters.dstAddress[5] += self->count;
+    }
+
+    stream->minTime = (controlBlock != NULL && controlBlock->minTime > 0) ? (uint32_t) controlBlock->minTime : self->config.minTime;
+    stream->maxTime = (controlBlock != NULL && controlBlock->maxTime > 0) ? (uint32_t) controlBlock->maxTime : self->config.maxTime;
+    if (stream->minTime == 0) stream->minTime = 1;
+    if (stream->maxTime < stream->minTime) stream->maxTime = stream->minTime;
+
+    // the first frame is due at the start, then every T0
+    stream->interval = stream->maxTime;
+    stream->next = 0;
+
+    stream->values = LinkedList_create();
+    stream->lock = Semaphore_create(1);
+
+    for (DataSetEntry* entry = dataSet->fcdas; entry != NULL && stream->values != NULL; entry = entry->sibling)
+    {
+        FunctionalConstraint fc;
+        ModelNode* node = SimDataSets_resolveEntry(model, entry, &fc);
+        MmsValue* value = (node != NULL) ? copyMember(stream, node, fc) : NULL;
+
+        if (value == NULL)
+        {
+            printf("Warning - GOOSE data set %s: member %s/%s not in the model, skipped... ", stream->dataSetRef,
+                entry->logicalDeviceName, entry->variableName);
+            releaseStream(stream);
+            return false;
+        }
+
+        LinkedList_add(stream->values, value);
+    }
+
+    if (stream->values == NULL || stream->lock == NULL)
+    {
+        releaseStream(stream);
+        return false;
+    }
+
+    stream->publisher = GoosePublisher_createEx(&parameters, self->interface, self->config.vlan);
+
+    if (stream->publisher == NULL)
+    {
+        printf("Warning - GOOSE data set %s: cannot publish on %s, skipped... ", stream->dataSetRef, self->interface);
+        releaseStream(stream);
+        return false;
+    }
+
+    GoosePublisher_setGoCbRef(stream->publisher, stream->goCbRef);
+    GoosePublisher_setDataSetRef(stream->publisher, stream->dataSetRef);
+    GoosePublisher_setGoID(stream->publisher, stream->goId);
+    GoosePublisher_setConfRev(stream->publisher, (controlBlock != NULL) ? controlBlock->confRev : 1);
+
+    return true;
+}
+
+// with the stream locked
+static void publish(SimGoose self, Stream* stream)
+{
+    // twice the time to the next frame, so a single lost frame does not expire the values
+    GoosePublisher_setTimeAllowedToLive(stream->publisher, 2 * stream->interval);
+
+    if (GoosePublisher_publish(stream->publisher, stream->values) != 0)
+        __atomic_add_fetch(&self->errors, 1, __ATOMIC_RELAXED);
+}
+
+static void* publisherThread(void* parameter)
+{
+    SimGoose self = (SimGoose) parameter;
+
+    while (true)
+    {
+        uint64_t now = Hal_getTimeInNs();
+        uint64_t next = UINT64_MAX;
+
+        for (int s = 0; s < self->count; s++)
+        {
+            Stream* stream = &self->streams[s];
+
+            Semaphore_wait(stream->lock);
+
+            if (now >= stream->next)
+            {
+                // T1, 2 T1, 4 T1, ... up to T0
+                stream->interval = (stream->interval < stream->maxTime / 2) ? stream->interval * 2 : stream->maxTime;
+                publish(self, stream);
+
+                // on schedule - unless it fell behind by more than an interval
+                stream->next = (stream->next + (uint64_t) stream->interval * 1000000 > now) ?
+                    stream->next + (uint64_t) stream->interval * 1000000 : now + (uint64_t) stream->interval * 1000000;
+
+                __atomic_add_fetch(&self->retransmissions, 1, __ATOMIC_RELAXED);
+            }
+
+            if (stream->next < next) next = stream->next;
+
+            Semaphore_post(stream->lock);
+        }
+
+        struct pollfd fd = { self->wakeup[0], POLLIN, 0 };
+        struct timespec timeout = { 0, 0 };
+
+        now = Hal_getTimeInNs();
+        if (next > now && next != UINT64_MAX)
+        {
+            timeout.tv_sec = (next - now) / 1000000000;
+            timeout.tv_nsec = (next - now) % 1000000000;
+        }
+
+        int ready = ppoll(&fd, 1, (next == UINT64_MAX) ? NULL : &timeout, NULL);
+
+        if (ready > 0)
+        {
+            // an event rescheduled a stream - or closed, stop
+            char buffer[64];
+            if (read(self->wakeup[0], buffer, sizeof(buffer)) == 0) break;
+        }
+    }
+
+    return NULL;
+}
+
+SimGoose SimGoose_create(const SimGooseConfig* config)
+{
+    SimGoose self = (SimGoose) calloc(1, sizeof(struct sSimGoose));
+
+    if (self == NULL) return NULL;
+
+    self->config = *config;
+    snprintf(self->interface, sizeof(self->interface), "%s", config->interface);
+    self->config.interface = self->interface;
+    self->latencyMin = UINT64_MAX;
+
+    if (pipe(self->wakeup) != 0)
+    {
+        free(self);
+        return NULL;
+    }
+
+    // an event never waits for the thread
+    fcntl(self->wakeup[1], F_SETFL, fcntl(self->wakeup[1], F_GETFL) | O_NONBLOCK);
+
+    return self;
+}
+
+void SimGoose_destroy(SimGoose self)
+{
+    if (self == NULL) return;
+
+    // closing the pipe wakes the thread up
+    close(self->wakeup[1]);
+
+    if (self->thread != NULL)
+        Thread_destroy(self->thread);
+
+    close(self->wakeup[0]);
+
+    for (int s = 0; s < self->count; s++)
+        releaseStream(&self->streams[s]);
+    free(self->streams);
+    free(self);
+}
+
+int SimGoose_add(SimGoose self, int owner, IedModel* model, const char* references)
+{
+    char* list = strdup(references);
+
+    if (list == NULL) return 0;
+
+    int added = 0;
+    char* context = NULL;
+
+    for (char* reference = strtok_r(list, ", ", &context); reference != NULL; reference = strtok_r(NULL, ", ", &context))
+    {
+        DataSet* dataSet = SimDataSets_find(model, reference);
+
+        // the data sets of the other models
+        if (dataSet == NULL) continue;
+
+        Stream* streams = (Stream*) realloc(self->streams, (self->count + 1) * sizeof(Stream));
+
+        if (streams == NULL) break;
+        self->streams = streams;
+
+        if (!createStream(self, &self->streams[self->count], owner, model, dataSet)) continue;
+
+        self->count++;
+        added++;
+    }
+
+    free(list);
+    return added;
+}
+
+bool SimGoose_start(SimGoose self)
+{
+    self->thread = Thread_create(publisherThread, self, false);
+
+    if (self->thread == NULL) return false;
+
+    Thread_start(self->thread);
+    return true;
+}
+
+void SimGoose_publishChanges(SimGoose self, int owner, uint64_t committed)
+{
+    bool published = false;
+
+    for (int s = 0; s < self->count; s++)
+    {
+        Stream* stream = &self->streams[s];
+
+        if (stream->owner != owner) continue;
+
+        bool changed = false;
+        for (int l = 0; l < stream->leafCount && !changed; l++)
+            changed = stream->leaves[l].triggered && !MmsValue_equals(stream->leaves[l].attribute->mmsValue, stream->leaves[l].value);
+
+        if (!changed) continue;
+
+        Semaphore_wait(stream->lock);
+
+        for (int l = 0; l < stream->leafCount; l++)
+            MmsValue_update(stream->leaves[l].value, stream->leaves[l].attribute->mmsValue);
+
+        GoosePublisher_increaseStNum(stream->publisher);
+        stream->interval = stream->minTime;
+        publish(self, stream);
+
+        uint64_t now = Hal_getTimeInNs();
+        stream->next = now + (uint64_t) stream->minTime * 1000000;
+
+        Semaphore_post(stream->lock);
+
+        uint64_t latency = (now > committed) ? now - committed : 0;
+        self->latencySum += latency;
+        if (latency < self->latencyMin) self->latencyMin = latency;
+        if (latency > self->latencyMax) self->latencyMax = latency;
+
+        __atomic_add_fetch(&self->events, 1, __ATOMIC_RELAXED);
+        published = true;
+    }
+
+    // the retransmissions start over at T1
+    if (published && write(self->wakeup[1], "", 1) < 0)
+    {
+        // full - the thread is woken up anyway
+    }
+}
+
+bool SimGoose_isPublishing(SimGoose self, int owner)
+{
+    if (self == NULL) return false;
+
+    for (int s = 0; s < self->count; s++)
+        if (self->streams[s].owner == owner) return true;
+
+    return false;
+}
+
+void SimGoose_getStatistics(SimGoose self, SimGooseStatistics* statistics)
+{
+    statistics->publishers = self->count;
+    statistics->events = __atomic_exchange_n(&self->events, 0, __ATOMIC_RELAXED);
+    statistics->retransmissions = __atomic_exchange_n(&self->retransmissions, 0, __ATOMIC_RELAXED);
+    statistics->errors = __atomic_exchange_n(&self->errors, 0, __ATOMIC_RELAXED);
+    statistics->latencyMinNs = (statistics->events > 0) ? self->latencyMin : 0;
+    statistics->latencyMaxNs = self->latencyMax;
+    statistics->latencyMeanNs = (statistics->events > 0) ? (double) self->latencySum / statistics->events : 0;
+
+    self->latencySum = 0;
+    self->latencyMin = UINT64_MAX;
+    self->latencyMax = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef SIM_GOOSE_H_
+#define SIM_GOOSE_H_
+
+#include "iec61850_model.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// GOOSE publishing of data sets of the simulated models (instead of the integrated publisher of the server) - a
+// changed data set is published at once by the simulation, then retransmitted by a thread of its own after T1,
+// 2 T1, 4 T1, ... up to the stable retransmission time T0
+typedef struct
+{
+    const char* interface;      // Ethernet interface, i.e. "eth0"
+    bool vlan;                  // VLAN tagged frames
+    uint16_t vlanId;
+    uint8_t vlanPriority;
+    uint16_t appId;             // APPID of the first data set, incremented for the next ones
+    uint8_t dstAddress[6];      // multicast address of the first data set, the last byte incremented for the next ones
+    uint32_t minTime;           // T1 [ms]
+    uint32_t maxTime;           // T0 [ms]
+} SimGooseConfig;
+
+// since the last call of SimGoose_getStatistics
+typedef struct
+{
+    int publishers;
+    uint64_t events;            // changes published at once
+    uint64_t retransmissions;
+    uint64_t errors;            // frames that could not be sent
+    uint64_t latencyMinNs;      // commit of the changed values -> frame sent
+    uint64_t latencyMaxNs;
+    double latencyMeanNs;
+} SimGooseStatistics;
+
+typedef struct sSimGoose* SimGoose;
+
+SimGoose SimGoose_create(const SimGooseConfig* config);
+
+// stops the thread, then releases the publishers - before the models are destroyed
+void SimGoose_destroy(SimGoose self);
+
+// data sets of a model with a server (its values are bound), comma separated references LD/LN$name; the owner
+// identifies the model for SimGoose_publishChanges - number of data sets published
+int SimGoose_add(SimGoose self, int owner, IedModel* model, const char* references);
+
+bool SimGoose_start(SimGoose self);
+
+// publishes the changed data sets of a model, with the data model locked; committed - time the values were
+// committed [ns] (Hal_getTimeInNs)
+void SimGoose_publishChanges(SimGoose self, int owner, uint64_t committed);
+
+bool SimGoose_isPublishing(SimGoose self, int owner);
+
+void SimGoose_getStatistics(SimGoose self, SimGooseStatistics* statistics);
+
+#endif /* SIM_GOOSE_H_ */
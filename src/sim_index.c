@@ -0,0 +1,148 @@
+#include "sim_index.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    uint32_t hash;
+    uint32_t key;           // offset + 1 in the key pool, 0 - empty
+    int slot;
+} Entry;
+
+struct sSimIndex
+{
+    Entry* entries;
+    uint32_t capacity;      // power of two
+    int count;
+
+    char* keys;
+    size_t keysLength;
+    size_t keysCapacity;
+};
+
+static uint32_t hashKey(const char* key, size_t length)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t c = 0; c < length; c++)
+        hash = (hash ^ (unsigned char) key[c]) * 16777619u;
+
+    return hash;
+}
+
+static bool grow(SimIndex self)
+{
+    uint32_t capacity = self->capacity * 2;
+    Entry* entries = (Entry*) calloc(capacity, sizeof(Entry));
+
+    if (entries == NULL) return false;
+
+    for (uint32_t e = 0; e < self->capacity; e++)
+    {
+        if (self->entries[e].key == 0) continue;
+
+        uint32_t position = self->entries[e].hash & (capacity - 1);
+        while (entries[position].key != 0) position = (position + 1) & (capacity - 1);
+        entries[position] = self->entries[e];
+    }
+
+    free(self->entries);
+    self->entries = entries;
+    self->capacity = capacity;
+    return true;
+}
+
+SimIndex SimIndex_create(int expected)
+{
+    SimIndex self = (SimIndex) calloc(1, sizeof(struct sSimIndex));
+
+    if (self == NULL) return NULL;
+
+    // load factor at most 1/2
+    self->capacity = 64;
+    while (self->capacity < (uint32_t) expected * 2 && self->capacity < (1u << 31)) self->capacity *= 2;
+
+    self->entries = (Entry*) calloc(self->capacity, sizeof(Entry));
+    if (self->entries == NULL)
+    {
+        free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void SimIndex_destroy(SimIndex self)
+{
+    if (self == NULL) return;
+
+    free(self->entries);
+    free(self->keys);
+    free(self);
+}
+
+bool SimIndex_put(SimIndex self, const char* key, int slot)
+{
+    if ((uint32_t) (self->count + 1) * 2 > self->capacity && !grow(self))
+        return false;
+
+    size_t length = strlen(key);
+    uint32_t hash = hashKey(key, length);
+    uint32_t position = hash & (self->capacity - 1);
+
+    for (; self->entries[position].key != 0; position = (position + 1) & (self->capacity - 1))
+    {
+        Entry* entry = &self->entries[position];
+
+        if (entry->hash == hash && strcmp(self->keys + entry->key - 1, key) == 0)
+        {
+            entry->slot = slot;
+            return true;
+        }
+    }
+
+    if (self->keysLength + length + 1 > self->keysCapacity)
+    {
+        size_t capacity = (self->keysCapacity > 0) ? self->keysCapacity : 4096;
+        while (capacity < self->keysLength + length + 1) capacity *= 2;
+
+        char* keys = (char*) realloc(self->keys, capacity);
+        if (keys == NULL) return false;
+
+        self->keys = keys;
+        self->keysCapacity = capacity;
+    }
+
+    memcpy(self->keys + self->keysLength, key, length + 1);
+
+    self->entries[position].hash = hash;
+    self->entries[position].key = (uint32_t) self->keysLength + 1;
+    self->entries[position].slot = slot;
+    self->keysLength += length + 1;
+    self->count++;
+
+    return true;
+}
+
+int SimIndex_get(SimIndex self, const char* key)
+{
+    if (self == NULL) return -1;
+
+    uint32_t hash = hashKey(key, strlen(key));
+
+    for (uint32_t position = hash & (self->capacity - 1); self->entries[position].key != 0; position = (position + 1) & (self->capacity - 1))
+    {
+        Entry* entry = &self->entries[position];
+
+        if (entry->hash == hash && strcmp(self->keys + entry->key - 1, key) == 0)
+            return entry->slot;
+    }
+
+    return -1;
+}
+
+int SimIndex_getCount(SimIndex self)
+{
+    return self->count;
+}
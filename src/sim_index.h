@@ -0,0 +1,21 @@
+#ifndef SIM_INDEX_H_
+#define SIM_INDEX_H_
+
+#include <stdbool.h>
+
+// hash index of object references (or any strings) to data point slots - open addressing, keys kept in a pool
+typedef struct sSimIndex* SimIndex;
+
+// expected - number of keys to size the index for (it grows when needed)
+SimIndex SimIndex_create(int expected);
+void SimIndex_destroy(SimIndex self);
+
+// adds (or replaces) the slot of a key
+bool SimIndex_put(SimIndex self, const char* key, int slot);
+
+// slot of a key, -1 - not found
+int SimIndex_get(SimIndex self, const char* key);
+
+int SimIndex_getCount(SimIndex self);
+
+#endif /* SIM_INDEX_H_ */
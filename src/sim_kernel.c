@@ -0,0 +1,447 @@
+#include "sim_kernel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #if defined(__SSE2__)
+        #define SIM_KERNEL_X86
+    #endif
+#endif
+
+#if defined(__aarch64__)
+    #include <arm_neon.h>
+    #define SIM_KERNEL_NEON
+#endif
+
+// sine approximation (cephes sinf): reduction to [-pi/4, pi/4] by quadrant, then sin/cos minimax polynomials
+#define SIN_2_PI    0.63661977236758134308f
+#define SIN_PIO2_1  1.5703125f
+#define SIN_PIO2_2  4.837512969970703125e-4f
+#define SIN_PIO2_3  7.54978995489188216e-8f
+#define SIN_S1     -1.6666654611e-1f
+#define SIN_S2      8.3321608736e-3f
+#define SIN_S3     -1.9515295891e-4f
+#define SIN_C1      4.166664568298827e-2f
+#define SIN_C2     -1.388731625493765e-3f
+#define SIN_C3      2.443315711809948e-5f
+
+// the argument C t + D is wrapped to [-pi, pi] in double before the sine - t grows without limit, so neither float
+// nor the reduction of the polynomial (only exact for small arguments) can take it as it is
+#define TWO_PI      6.283185307179586476925
+#define INV_TWO_PI  0.159154943091895335769
+
+typedef void (*SimKernelFunction)(const SimKernelInput* in, double t, float* out, int first, int end);
+
+static inline float wrapPhase(float c, float d, double t)
+{
+    double x = (double) c * t + (double) d;
+    return (float) (x - rint(x * INV_TWO_PI) * TWO_PI);
+}
+
+static inline float sinPoly(float x)
+{
+    int k = (int) lrintf(x * SIN_2_PI);
+    float kf = (float) k;
+    float r = ((x - kf * SIN_PIO2_1) - kf * SIN_PIO2_2) - kf * SIN_PIO2_3;
+    float r2 = r * r;
+    float v;
+
+    if (k & 1)
+        v = 1.0f - 0.5f * r2 + r2 * r2 * (SIN_C1 + r2 * (SIN_C2 + r2 * SIN_C3));
+    else
+        v = r + r * r2 * (SIN_S1 + r2 * (SIN_S2 + r2 * SIN_S3));
+
+    return (k & 2) ? -v : v;
+}
+
+static inline float evaluateOne(const SimKernelInput* in, double t, int i)
+{
+    float a = in->A[i] * (1.0f + in->Ar[i] * in->noiseA[i]);
+    float b = in->B[i] * (1.0f + in->Br[i] * in->noiseB[i]);
+    float c = in->C[i] * (1.0f + in->Cr[i] * in->noiseC[i]);
+    float d = in->D[i] * (1.0f + in->Dr[i] * in->noiseD[i]);
+
+    return a + b * sinPoly(wrapPhase(c, d, t));
+}
+
+// scalar reference - libm sinf
+static void kernelScalar(const SimKernelInput* in, double t, float* out, int first, int end)
+{
+    for (int i = first; i < end; i++)
+    {
+        float a = in->A[i] * (1.0f + in->Ar[i] * in->noiseA[i]);
+        float b = in->B[i] * (1.0f + in->Br[i] * in->noiseB[i]);
+        float c = in->C[i] * (1.0f + in->Cr[i] * in->noiseC[i]);
+        float d = in->D[i] * (1.0f + in->Dr[i] * in->noiseD[i]);
+
+        out[i] = a + b * sinf(wrapPhase(c, d, t));
+    }
+}
+
+// same operations as the fma vector kernels (lane by lane), so a result never depends on the position in the batch
+static inline float sinPolyFma(float x)
+{
+    int k = (int) lrintf(x * SIN_2_PI);
+    float kf = (float) k;
+    float r = fmaf(-kf, SIN_PIO2_3, fmaf(-kf, SIN_PIO2_2, fmaf(-kf, SIN_PIO2_1, x)));
+    float r2 = r * r;
+    float v;
+
+    if (k & 1)
+        v = fmaf(r2 * r2, fmaf(r2, fmaf(r2, SIN_C3, SIN_C2), SIN_C1), fmaf(-0.5f, r2, 1.0f));
+    else
+        v = fmaf(r * r2, fmaf(r2, fmaf(r2, SIN_S3, SIN_S2), SIN_S1), r);
+
+    return (k & 2) ? -v : v;
+}
+
+static inline float evaluateOneFma(const SimKernelInput* in, double t, int i)
+{
+    float a = in->A[i] * (1.0f + in->Ar[i] * in->noiseA[i]);
+    float b = in->B[i] * (1.0f + in->Br[i] * in->noiseB[i]);
+    float c = in->C[i] * (1.0f + in->Cr[i] * in->noiseC[i]);
+    float d = in->D[i] * (1.0f + in->Dr[i] * in->noiseD[i]);
+
+    return fmaf(b, sinPolyFma(wrapPhase(c, d, t)), a);
+}
+
+// polynomial tails for the vector kernels, so a batch never mixes two sine implementations
+static void kernelTail(const SimKernelInput* in, double t, float* out, int first, int end)
+{
+    for (int i = first; i < end; i++)
+        out[i] = evaluateOne(in, t, i);
+}
+
+static void kernelTailFma(const SimKernelInput* in, double t, float* out, int first, int end)
+{
+    for (int i = first; i < end; i++)
+        out[i] = evaluateOneFma(in, t, i);
+}
+
+#ifdef SIM_KERNEL_X86
+
+static inline __m128 salt128(const float* x, const float* xr, const float* noise, int i)
+{
+    __m128 v = _mm_loadu_ps(x + i);
+    __m128 r = _mm_loadu_ps(xr + i);
+    __m128 n = _mm_loadu_ps(noise + i);
+    return _mm_mul_ps(v, _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(r, n)));
+}
+
+// wrapPhase of 4 lanes - SSE2 has no rounding instruction, the magic number rounds to nearest even like rint
+static inline __m128 wrap128(__m128 c, __m128 d, __m128d t)
+{
+    const __m128d magic = _mm_set1_pd(6755399441055744.0);
+    __m128d x[2] = {
+        _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(c), t), _mm_cvtps_pd(d)),
+        _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(c, c)), t), _mm_cvtps_pd(_mm_movehl_ps(d, d)))
+    };
+
+    for (int h = 0; h < 2; h++)
+    {
+        __m128d k = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(x[h], _mm_set1_pd(INV_TWO_PI)), magic), magic);
+        x[h] = _mm_sub_pd(x[h], _mm_mul_pd(k, _mm_set1_pd(TWO_PI)));
+    }
+
+    return _mm_movelh_ps(_mm_cvtpd_ps(x[0]), _mm_cvtpd_ps(x[1]));
+}
+
+static inline __m128 sin128(__m128 x)
+{
+    __m128i k = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(SIN_2_PI)));
+    __m128 kf = _mm_cvtepi32_ps(k);
+
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(kf, _mm_set1_ps(SIN_PIO2_1)));
+    r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(SIN_PIO2_2)));
+    r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(SIN_PIO2_3)));
+    __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_set1_ps(SIN_S2), _mm_mul_ps(r2, _mm_set1_ps(SIN_S3)));
+    s = _mm_add_ps(_mm_set1_ps(SIN_S1), _mm_mul_ps(r2, s));
+    s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+
+    __m128 c = _mm_add_ps(_mm_set1_ps(SIN_C2), _mm_mul_ps(r2, _mm_set1_ps(SIN_C3)));
+    c = _mm_add_ps(_mm_set1_ps(SIN_C1), _mm_mul_ps(r2, c));
+    c = _mm_mul_ps(_mm_mul_ps(r2, r2), c);
+    c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), c);
+
+    __m128i one = _mm_set1_epi32(1);
+    __m128 odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(k, one), one));
+    __m128 v = _mm_or_ps(_mm_and_ps(odd, c), _mm_andnot_ps(odd, s));
+
+    __m128i sign = _mm_slli_epi32(_mm_and_si128(k, _mm_set1_epi32(2)), 30);
+    return _mm_xor_ps(v, _mm_castsi128_ps(sign));
+}
+
+static void kernelSse(const SimKernelInput* in, double t, float* out, int first, int end)
+{
+    __m128d vt = _mm_set1_pd(t);
+    int i = first;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 a = salt128(in->A, in->Ar, in->noiseA, i);
+        __m128 b = salt128(in->B, in->Br, in->noiseB, i);
+        __m128 c = salt128(in->C, in->Cr, in->noiseC, i);
+        __m128 d = salt128(in->D, in->Dr, in->noiseD, i);
+
+        __m128 v = _mm_add_ps(a, _mm_mul_ps(b, sin128(wrap128(c, d, vt))));
+        _mm_storeu_ps(out + i, v);
+    }
+
+    kernelTail(in, t, out, i, end);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 salt256(const float* x, const float* xr, const float* noise, int i)
+{
+    __m256 v = _mm256_loadu_ps(x + i);
+    __m256 r = _mm256_loadu_ps(xr + i);
+    __m256 n = _mm256_loadu_ps(noise + i);
+    return _mm256_mul_ps(v, _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(r, n)));
+}
+
+// wrapPhase of 8 lanes, without fma so it rounds exactly like the other kernels
+__attribute__((target("avx2,fma")))
+static inline __m256 wrap256(__m256 c, __m256 d, __m256d t)
+{
+    __m256d x[2] = {
+        _mm256_add_pd(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(c)), t), _mm256_cvtps_pd(_mm256_castps256_ps128(d))),
+        _mm256_add_pd(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(c, 1)), t), _mm256_cvtps_pd(_mm256_extractf128_ps(d, 1)))
+    };
+
+    for (int h = 0; h < 2; h++)
+    {
+        __m256d k = _mm256_round_pd(_mm256_mul_pd(x[h], _mm256_set1_pd(INV_TWO_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        x[h] = _mm256_sub_pd(x[h], _mm256_mul_pd(k, _mm256_set1_pd(TWO_PI)));
+    }
+
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(x[0])), _mm256_cvtpd_ps(x[1]), 1);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 sin256(__m256 x)
+{
+    __m256i k = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(SIN_2_PI)));
+    __m256 kf = _mm256_cvtepi32_ps(k);
+
+    __m256 r = _mm256_fnmadd_ps(kf, _mm256_set1_ps(SIN_PIO2_1), x);
+    r = _mm256_fnmadd_ps(kf, _mm256_set1_ps(SIN_PIO2_2), r);
+    r = _mm256_fnmadd_ps(kf, _mm256_set1_ps(SIN_PIO2_3), r);
+    __m256 r2 = _mm256_mul_ps(r, r);
+
+    __m256 s = _mm256_fmadd_ps(r2, _mm256_set1_ps(SIN_S3), _mm256_set1_ps(SIN_S2));
+    s = _mm256_fmadd_ps(r2, s, _mm256_set1_ps(SIN_S1));
+    s = _mm256_fmadd_ps(_mm256_mul_ps(r, r2), s, r);
+
+    __m256 c = _mm256_fmadd_ps(r2, _mm256_set1_ps(SIN_C3), _mm256_set1_ps(SIN_C2));
+    c = _mm256_fmadd_ps(r2, c, _mm256_set1_ps(SIN_C1));
+    c = _mm256_fmadd_ps(_mm256_mul_ps(r2, r2), c, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), r2, _mm256_set1_ps(1.0f)));
+
+    __m256i one = _mm256_set1_epi32(1);
+    __m256 odd = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(k, one), one));
+    __m256 v = _mm256_blendv_ps(s, c, odd);
+
+    __m256i sign = _mm256_slli_epi32(_mm256_and_si256(k, _mm256_set1_epi32(2)), 30);
+    return _mm256_xor_ps(v, _mm256_castsi256_ps(sign));
+}
+
+__attribute__((target("avx2,fma")))
+static void kernelAvx2(const SimKernelInput* in, double t, float* out, int first, int end)
+{
+    __m256d vt = _mm256_set1_pd(t);
+    int i = first;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 a = salt256(in->A, in->Ar, in->noiseA, i);
+        __m256 b = salt256(in->B, in->Br, in->noiseB, i);
+        __m256 c = salt256(in->C, in->Cr, in->noiseC, i);
+        __m256 d = salt256(in->D, in->Dr, in->noiseD, i);
+
+        __m256 v = _mm256_fmadd_ps(b, sin256(wrap256(c, d, vt)), a);
+        _mm256_storeu_ps(out + i, v);
+    }
+
+    kernelTailFma(in, t, out, i, end);
+}
+
+#endif /* SIM_KERNEL_X86 */
+
+#ifdef SIM_KERNEL_NEON
+
+static inline float32x4_t saltNeon(const float* x, const float* xr, const float* noise, int i)
+{
+    float32x4_t v = vld1q_f32(x + i);
+    float32x4_t r = vld1q_f32(xr + i);
+    float32x4_t n = vld1q_f32(noise + i);
+    return vmulq_f32(v, vaddq_f32(vdupq_n_f32(1.0f), vmulq_f32(r, n)));
+}
+
+// wrapPhase of 4 lanes, without fma so it rounds exactly like the other kernels
+static inline float32x4_t wrapNeon(float32x4_t c, float32x4_t d, float64x2_t t)
+{
+    float64x2_t x[2] = {
+        vaddq_f64(vmulq_f64(vcvt_f64_f32(vget_low_f32(c)), t), vcvt_f64_f32(vget_low_f32(d))),
+        vaddq_f64(vmulq_f64(vcvt_high_f64_f32(c), t), vcvt_high_f64_f32(d))
+    };
+
+    for (int h = 0; h < 2; h++)
+    {
+        float64x2_t k = vrndnq_f64(vmulq_n_f64(x[h], INV_TWO_PI));
+        x[h] = vsubq_f64(x[h], vmulq_n_f64(k, TWO_PI));
+    }
+
+    return vcvt_high_f32_f64(vcvt_f32_f64(x[0]), x[1]);
+}
+
+static inline float32x4_t sinNeon(float32x4_t x)
+{
+    int32x4_t k = vcvtnq_s32_f32(vmulq_n_f32(x, SIN_2_PI));
+    float32x4_t kf = vcvtq_f32_s32(k);
+
+    float32x4_t r = vfmsq_f32(x, kf, vdupq_n_f32(SIN_PIO2_1));
+    r = vfmsq_f32(r, kf, vdupq_n_f32(SIN_PIO2_2));
+    r = vfmsq_f32(r, kf, vdupq_n_f32(SIN_PIO2_3));
+    float32x4_t r2 = vmulq_f32(r, r);
+
+    float32x4_t s = vfmaq_f32(vdupq_n_f32(SIN_S2), r2, vdupq_n_f32(SIN_S3));
+    s = vfmaq_f32(vdupq_n_f32(SIN_S1), r2, s);
+    s = vfmaq_f32(r, vmulq_f32(r, r2), s);
+
+    float32x4_t c = vfmaq_f32(vdupq_n_f32(SIN_C2), r2, vdupq_n_f32(SIN_C3));
+    c = vfmaq_f32(vdupq_n_f32(SIN_C1), r2, c);
+    c = vfmaq_f32(vfmsq_f32(vdupq_n_f32(1.0f), vdupq_n_f32(0.5f), r2), vmulq_f32(r2, r2), c);
+
+    uint32x4_t odd = vtstq_s32(k, vdupq_n_s32(1));
+    float32x4_t v = vbslq_f32(odd, c, s);
+
+    uint32x4_t sign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(k), vdupq_n_u32(2)), 30);
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), sign));
+}
+
+static void kernelNeon(const SimKernelInput* in, double t, float* out, int first, int end)
+{
+    float64x2_t vt = vdupq_n_f64(t);
+    int i = first;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        float32x4_t a = saltNeon(in->A, in->Ar, in->noiseA, i);
+        float32x4_t b = saltNeon(in->B, in->Br, in->noiseB, i);
+        float32x4_t c = saltNeon(in->C, in->Cr, in->noiseC, i);
+        float32x4_t d = saltNeon(in->D, in->Dr, in->noiseD, i);
+
+        float32x4_t v = vfmaq_f32(a, b, sinNeon(wrapNeon(c, d, vt)));
+        vst1q_f32(out + i, v);
+    }
+
+    kernelTailFma(in, t, out, i, end);
+}
+
+#endif /* SIM_KERNEL_NEON */
+
+typedef struct
+{
+    const char* name;
+    SimKernelFunction function;
+    bool (*isSupported)(void);
+} SimKernel;
+
+static bool alwaysSupported(void) { return true; }
+
+#ifdef SIM_KERNEL_X86
+static bool avx2Supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+#endif
+
+// ordered from the most preferred
+static const SimKernel kernels[] = {
+#ifdef SIM_KERNEL_X86
+    { "avx2", kernelAvx2, avx2Supported },
+    { "sse", kernelSse, alwaysSupported },
+#endif
+#ifdef SIM_KERNEL_NEON
+    { "neon", kernelNeon, alwaysSupported },
+#endif
+    { "scalar", kernelScalar, alwaysSupported }
+};
+
+static const SimKernel* kernel = &kernels[sizeof(kernels) / sizeof(kernels[0]) - 1];
+
+bool SimKernel_select(const char* name)
+{
+    int n = sizeof(kernels) / sizeof(kernels[0]);
+    bool automatic = (name == NULL || strcasecmp(name, "auto") == 0);
+
+    for (int k = 0; k < n; k++)
+    {
+        if (!automatic && strcasecmp(name, kernels[k].name) != 0) continue;
+
+        if (kernels[k].isSupported())
+        {
+            kernel = &kernels[k];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* SimKernel_getName(void)
+{
+    return kernel->name;
+}
+
+void SimKernel_evaluate(const SimKernelInput* input, double t, float* out, int count)
+{
+    if (count > 0) kernel->function(input, t, out, 0, count);
+}
+
+double SimKernel_selfTest(void)
+{
+    // A = 0, B = 1, no noise -> out = sin(C t + D)
+    enum { SAMPLES = 4096 };
+
+    static float zero[SAMPLES] SIM_ALIGNED, one[SAMPLES] SIM_ALIGNED;
+    static float c[SAMPLES] SIM_ALIGNED, d[SAMPLES] SIM_ALIGNED, out[SAMPLES] SIM_ALIGNED;
+
+    SimKernelInput input = { zero, zero, one, zero, c, zero, d, zero, zero, zero, zero, zero };
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        zero[i] = 0.0f;
+        one[i] = 1.0f;
+    }
+
+    double maxError = 0.0;
+
+    // D over [-2pi, 2pi] densely and up to 10^4 rad, then C t of 25..75 Hz after a week of simulation (~10^8 rad)
+    for (int pass = 0; pass < 3; pass++)
+    {
+        double t = (pass < 2) ? 0.0 : 7 * 86400.0;
+        float range = (pass == 0) ? 2.0f * (float) M_PI : 10000.0f;
+
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            c[i] = (pass < 2) ? 1.0f : (float) (2.0 * M_PI * (25.0 + 50.0 * i / (SAMPLES - 1)));
+            d[i] = (pass < 2) ? -range + 2.0f * range * i / (SAMPLES - 1) : 0.0f;
+        }
+
+        SimKernel_evaluate(&input, t, out, SAMPLES);
+
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            double error = fabs((double) out[i] - sin((double) c[i] * t + (double) d[i]));
+            if (error > maxError || isnan(out[i])) maxError = isnan(out[i]) ? INFINITY : error;
+        }
+    }
+
+    return maxError;
+}
@@ -0,0 +1,36 @@
+#ifndef SIM_KERNEL_H_
+#define SIM_KERNEL_H_
+
+#include <stdbool.h>
+
+// alignment of the coefficient / value arrays handed to the kernels
+#define SIM_KERNEL_ALIGNMENT 64
+#define SIM_ALIGNED __attribute__((aligned(SIM_KERNEL_ALIGNMENT)))
+
+// structure-of-arrays input of f = A + B sin(C t + D), all arrays hold (at least) count elements;
+// the noise arrays hold uniform values from [-1, 1] that salt the coefficients (X * (1 + Xr * noise))
+typedef struct
+{
+    const float* A; const float* Ar;
+    const float* B; const float* Br;
+    const float* C; const float* Cr;
+    const float* D; const float* Dr;
+
+    const float* noiseA;
+    const float* noiseB;
+    const float* noiseC;
+    const float* noiseD;
+} SimKernelInput;
+
+// selects the kernel by name (auto, scalar, sse, avx2, neon); false if not supported on this CPU
+bool SimKernel_select(const char* name);
+
+const char* SimKernel_getName(void);
+
+// evaluates count data points into out, t - simulation time [s] (C t + D is wrapped in double, any t is exact)
+void SimKernel_evaluate(const SimKernelInput* input, double t, float* out, int count);
+
+// compares the sine approximation of the selected kernel against sinf, returns the max. absolute error
+double SimKernel_selfTest(void);
+
+#endif /* SIM_KERNEL_H_ */
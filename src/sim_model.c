@@ -0,0 +1,292 @@
+#include "sim_model.h"
+#include "sim_scl.h"
+#include "sim_cache.h"
+#include "iec61850_config_file_parser.h"
+#include "iec61850_dynamic_model.h"
+#include "mms_value.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define ARENA_ALIGN(size) (((size) + 7) & ~(size_t) 7)
+
+struct sSimModelTemplate
+{
+    char* filename;
+    char* iedName;
+    IedModel* model;
+    SimCache cache;
+    bool cached;            // model mapped from the cache
+    size_t instanceSize;
+    int logicalNodesCount;
+};
+
+typedef struct
+{
+    char* base;
+    size_t used;
+
+    // logical nodes of the template and their copies, to relink the control blocks
+    LogicalNode** templateNodes;
+    LogicalNode** instanceNodes;
+    int nodesCount;
+} Arena;
+
+static void* arenaAlloc(Arena* arena, size_t size)
+{
+    void* block = arena->base + arena->used;
+    arena->used += ARENA_ALIGN(size);
+    return block;
+}
+
+static size_t nodeSize(ModelNode* node)
+{
+    switch (node->modelType)
+    {
+        case LogicalDeviceModelType: return sizeof(LogicalDevice);
+        case LogicalNodeModelType: return sizeof(LogicalNode);
+        case DataObjectModelType: return sizeof(DataObject);
+        default: return sizeof(DataAttribute);
+    }
+}
+
+static size_t measureTree(ModelNode* node, int* logicalNodes)
+{
+    size_t size = 0;
+
+    for (; node != NULL; node = node->sibling)
+    {
+        if (node->modelType == LogicalNodeModelType) (*logicalNodes)++;
+        size += ARENA_ALIGN(nodeSize(node)) + measureTree(node->firstChild, logicalNodes);
+    }
+
+    return size;
+}
+
+static size_t measureModel(IedModel* model, int* logicalNodes)
+{
+    size_t size = ARENA_ALIGN(sizeof(IedModel));
+
+    *logicalNodes = 0;
+    size += measureTree((ModelNode*) model->firstChild, logicalNodes);
+
+    for (DataSet* ds = model->dataSets; ds != NULL; ds = ds->sibling)
+    {
+        size += ARENA_ALIGN(sizeof(DataSet));
+        for (DataSetEntry* entry = ds->fcdas; entry != NULL; entry = entry->sibling)
+            size += ARENA_ALIGN(sizeof(DataSetEntry));
+    }
+    for (ReportControlBlock* rcb = model->rcbs; rcb != NULL; rcb = rcb->sibling) size += ARENA_ALIGN(sizeof(ReportControlBlock));
+    for (GSEControlBlock* gcb = model->gseCBs; gcb != NULL; gcb = gcb->sibling) size += ARENA_ALIGN(sizeof(GSEControlBlock));
+    for (SVControlBlock* svcb = model->svCBs; svcb != NULL; svcb = svcb->sibling) size += ARENA_ALIGN(sizeof(SVControlBlock));
+    for (SettingGroupControlBlock* sgcb = model->sgcbs; sgcb != NULL; sgcb = sgcb->sibling) size += ARENA_ALIGN(sizeof(SettingGroupControlBlock));
+    for (LogControlBlock* lcb = model->lcbs; lcb != NULL; lcb = lcb->sibling) size += ARENA_ALIGN(sizeof(LogControlBlock));
+    for (Log* log = model->logs; log != NULL; log = log->sibling) size += ARENA_ALIGN(sizeof(Log));
+
+    return size;
+}
+
+// copies a list of sibling nodes (and their subtrees), names stay shared with the template
+static ModelNode* copyTree(Arena* arena, ModelNode* node, ModelNode* parent)
+{
+    ModelNode* first = NULL;
+    ModelNode* last = NULL;
+
+    for (; node != NULL; node = node->sibling)
+    {
+        size_t size = nodeSize(node);
+        ModelNode* copy = (ModelNode*) arenaAlloc(arena, size);
+
+        memcpy(copy, node, size);
+        copy->parent = parent;
+        copy->sibling = NULL;
+
+        if (node->modelType == DataAttributeModelType)
+        {
+            // initial value - consumed (and replaced by the value cache) by the server
+            DataAttribute* da = (DataAttribute*) copy;
+            da->mmsValue = (da->mmsValue != NULL) ? MmsValue_clone(da->mmsValue) : NULL;
+        }
+        else if (node->modelType == LogicalNodeModelType)
+        {
+            arena->templateNodes[arena->nodesCount] = (LogicalNode*) node;
+            arena->instanceNodes[arena->nodesCount] = (LogicalNode*) copy;
+            arena->nodesCount++;
+        }
+
+        copy->firstChild = copyTree(arena, node->firstChild, copy);
+
+        if (last != NULL) last->sibling = copy; else first = copy;
+        last = copy;
+    }
+
+    return first;
+}
+
+static LogicalNode* mapLogicalNode(Arena* arena, LogicalNode* node)
+{
+    for (int n = 0; n < arena->nodesCount; n++)
+        if (arena->templateNodes[n] == node)
+            return arena->instanceNodes[n];
+
+    return NULL;
+}
+
+// copies a list of control blocks, relinking them to the logical nodes of the instance
+#define COPY_CONTROL_BLOCKS(Type, list) \
+    { \
+        Type* last = NULL; \
+        for (Type* cb = (list); cb != NULL; cb = cb->sibling) \
+        { \
+            Type* copy = (Type*) arenaAlloc(&arena, sizeof(Type)); \
+            memcpy(copy, cb, sizeof(Type)); \
+            copy->parent = mapLogicalNode(&arena, cb->parent); \
+            copy->sibling = NULL; \
+            if (last != NULL) last->sibling = copy; else (list) = copy; \
+            last = copy; \
+        } \
+    }
+
+static IedModel* parseModel(const char* filename, const char* iedName)
+{
+    size_t length = strlen(filename);
+
+    if (length > 4 && strcasecmp(filename + length - 4, ".cfg") == 0)
+        return ConfigFileParser_createModelFromConfigFileEx(filename);
+
+    return SimScl_loadModel(filename, (iedName != NULL && iedName[0]) ? iedName : NULL);
+}
+
+SimModelTemplate SimModelTemplate_load(const char* filename, const char* iedName, const char* cacheDirectory)
+{
+    SimCache cache = (cacheDirectory != NULL && cacheDirectory[0]) ? SimCache_create(cacheDirectory, filename, iedName) : NULL;
+    IedModel* model = (cache != NULL) ? SimCache_load(cache) : NULL;
+    bool cached = (model != NULL);
+
+    if (model == NULL)
+    {
+        model = parseModel(filename, iedName);
+
+        if (model != NULL && cache != NULL && !SimCache_store(cache, model))
+            printf("Warning - model cache %s could not be written\n", SimCache_getFilename(cache));
+    }
+
+    if (model == NULL)
+    {
+        SimCache_destroy(cache);
+        return NULL;
+    }
+
+    SimModelTemplate self = (SimModelTemplate) calloc(1, sizeof(struct sSimModelTemplate));
+
+    self->filename = strdup(filename);
+    self->iedName = strdup(iedName != NULL ? iedName : "");
+    self->model = model;
+    self->cache = cache;
+    self->cached = cached;
+    self->instanceSize = measureModel(model, &self->logicalNodesCount);
+
+    return self;
+}
+
+void SimModelTemplate_destroy(SimModelTemplate self)
+{
+    if (self == NULL) return;
+
+    // a model mapped from the cache is released with the cache
+    if (!self->cached)
+        IedModel_destroy(self->model);
+    SimCache_destroy(self->cache);
+
+    free(self->filename);
+    free(self->iedName);
+    free(self);
+}
+
+IedModel* SimModelTemplate_instantiate(SimModelTemplate self)
+{
+    Arena arena;
+
+    arena.base = (char*) calloc(1, self->instanceSize);
+    arena.used = 0;
+    arena.nodesCount = 0;
+    arena.templateNodes = (LogicalNode**) calloc(self->logicalNodesCount + 1, sizeof(LogicalNode*));
+    arena.instanceNodes = (LogicalNode**) calloc(self->logicalNodesCount + 1, sizeof(LogicalNode*));
+
+    if (arena.base == NULL || arena.templateNodes == NULL || arena.instanceNodes == NULL)
+    {
+        free(arena.base);
+        free(arena.templateNodes);
+        free(arena.instanceNodes);
+        return NULL;
+    }
+
+    // the model itself is the first block, so freeing it releases the whole instance
+    IedModel* model = (IedModel*) arenaAlloc(&arena, sizeof(IedModel));
+    memcpy(model, self->model, sizeof(IedModel));
+
+    model->firstChild = (LogicalDevice*) copyTree(&arena, (ModelNode*) self->model->firstChild, (ModelNode*) model);
+
+    DataSet* lastDataSet = NULL;
+    for (DataSet* ds = self->model->dataSets; ds != NULL; ds = ds->sibling)
+    {
+        DataSet* copy = (DataSet*) arenaAlloc(&arena, sizeof(DataSet));
+        memcpy(copy, ds, sizeof(DataSet));
+        copy->sibling = NULL;
+        copy->fcdas = NULL;
+
+        DataSetEntry* lastEntry = NULL;
+        for (DataSetEntry* entry = ds->fcdas; entry != NULL; entry = entry->sibling)
+        {
+            DataSetEntry* entryCopy = (DataSetEntry*) arenaAlloc(&arena, sizeof(DataSetEntry));
+            memcpy(entryCopy, entry, sizeof(DataSetEntry));
+            entryCopy->isLDNameDynamicallyAllocated = false;
+            entryCopy->value = NULL;
+            entryCopy->sibling = NULL;
+
+            if (lastEntry != NULL) lastEntry->sibling = entryCopy; else copy->fcdas = entryCopy;
+            lastEntry = entryCopy;
+        }
+
+        if (lastDataSet != NULL) lastDataSet->sibling = copy; else model->dataSets = copy;
+        lastDataSet = copy;
+    }
+
+    COPY_CONTROL_BLOCKS(ReportControlBlock, model->rcbs);
+    COPY_CONTROL_BLOCKS(GSEControlBlock, model->gseCBs);
+    COPY_CONTROL_BLOCKS(SVControlBlock, model->svCBs);
+    COPY_CONTROL_BLOCKS(SettingGroupControlBlock, model->sgcbs);
+    COPY_CONTROL_BLOCKS(LogControlBlock, model->lcbs);
+    COPY_CONTROL_BLOCKS(Log, model->logs);
+
+    free(arena.templateNodes);
+    free(arena.instanceNodes);
+
+    return model;
+}
+
+void SimModelTemplate_destroyInstance(IedModel* model)
+{
+    free(model);
+}
+
+size_t SimModelTemplate_getInstanceSize(SimModelTemplate self)
+{
+    return self->instanceSize;
+}
+
+bool SimModelTemplate_isCached(SimModelTemplate self)
+{
+    return self->cached;
+}
+
+const char* SimModelTemplate_getFilename(SimModelTemplate self)
+{
+    return self->filename;
+}
+
+const char* SimModelTemplate_getIedName(SimModelTemplate self)
+{
+    return self->iedName;
+}
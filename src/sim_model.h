@@ -0,0 +1,31 @@
+#ifndef SIM_MODEL_H_
+#define SIM_MODEL_H_
+
+#include "iec61850_model.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// immutable model parsed once from a model file and shared by all instances of the same model;
+// an instance gets its own compact copy of the node skeleton (libiec61850 binds the value cache of a server
+// into the data attributes), while names, references and control block parameters stay in the template
+typedef struct sSimModelTemplate* SimModelTemplate;
+
+// SCL file (ICD, CID, IID or SCD - iedName selects the IED, empty - the first one) or model configuration file (.cfg);
+// with a cache directory the parsed model is mapped from (or written to) the binary model cache
+SimModelTemplate SimModelTemplate_load(const char* filename, const char* iedName, const char* cacheDirectory);
+void SimModelTemplate_destroy(SimModelTemplate self);
+
+// new instance model - a single allocation, released with SimModelTemplate_destroyInstance
+IedModel* SimModelTemplate_instantiate(SimModelTemplate self);
+void SimModelTemplate_destroyInstance(IedModel* model);
+
+// bytes allocated per instance (without the values of the server)
+size_t SimModelTemplate_getInstanceSize(SimModelTemplate self);
+
+// model mapped from the cache instead of being parsed
+bool SimModelTemplate_isCached(SimModelTemplate self);
+
+const char* SimModelTemplate_getFilename(SimModelTemplate self);
+const char* SimModelTemplate_getIedName(SimModelTemplate self);
+
+#endif /* SIM_MODEL_H_ */
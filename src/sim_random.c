@@ -0,0 +1,207 @@
+#include "sim_random.h"
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+static SimRandomAlgorithm defaultAlgorithm = SIM_RANDOM_XOSHIRO;
+static uint64_t defaultSeed = 0x853c49e6748fea9bULL;
+static uint64_t generation = 1;
+static uint64_t streams = 0;
+
+static __thread SimRandom threadState;
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t splitmix64(uint64_t* x)
+{
+    return mix64(*x += 0x9e3779b97f4a7c15ULL);
+}
+
+static inline uint64_t nextXoshiro(uint64_t* s)
+{
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+// s[0] - state, s[1] - increment (odd)
+static inline uint32_t nextPcg(uint64_t* s)
+{
+    uint64_t old = s[0];
+    s[0] = old * 6364136223846793005ULL + s[1];
+
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+static inline uint64_t next64(SimRandom* self)
+{
+    if (self->algorithm == SIM_RANDOM_PCG)
+    {
+        // two statements - the order of the calls within one expression is unspecified
+        uint64_t high = nextPcg(self->s);
+        uint64_t low = nextPcg(self->s);
+        return (high << 32) | low;
+    }
+
+    return nextXoshiro(self->s);
+}
+
+bool SimRandom_parseAlgorithm(const char* name, SimRandomAlgorithm* algorithm)
+{
+    if (name == NULL) return false;
+
+    if (strcasecmp(name, "xoshiro") == 0) *algorithm = SIM_RANDOM_XOSHIRO;
+    else if (strcasecmp(name, "pcg") == 0) *algorithm = SIM_RANDOM_PCG;
+    else return false;
+
+    return true;
+}
+
+const char* SimRandom_getAlgorithmName(SimRandomAlgorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case SIM_RANDOM_XOSHIRO: return "xoshiro";
+        case SIM_RANDOM_PCG: return "pcg";
+    }
+    return "?";
+}
+
+void SimRandom_configure(SimRandomAlgorithm algorithm, uint64_t seed)
+{
+    defaultAlgorithm = algorithm;
+    defaultSeed = seed;
+    __atomic_store_n(&streams, 0, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&generation, 1, __ATOMIC_SEQ_CST);
+}
+
+uint64_t SimRandom_getSeed(void)
+{
+    return defaultSeed;
+}
+
+SimRandom* SimRandom_thread(void)
+{
+    uint64_t current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+
+    if (threadState.generation != current)
+    {
+        SimRandom_init(&threadState, defaultAlgorithm, defaultSeed, __atomic_fetch_add(&streams, 1, __ATOMIC_SEQ_CST));
+        threadState.generation = current;
+    }
+
+    return &threadState;
+}
+
+void SimRandom_init(SimRandom* self, SimRandomAlgorithm algorithm, uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed ^ rotl(stream * 0xd1b54a32d192ed03ULL, 32);
+
+    self->algorithm = algorithm;
+    self->generation = 0;
+
+    for (int i = 0; i < 4; i++)
+        self->s[i] = splitmix64(&x);
+
+    if (algorithm == SIM_RANDOM_PCG)
+    {
+        self->s[1] |= 1;
+        nextPcg(self->s);
+    }
+}
+
+uint64_t SimRandom_next(SimRandom* self)
+{
+    return next64(self);
+}
+
+uint32_t SimRandom_range(SimRandom* self, uint32_t n)
+{
+    return (uint32_t)(((next64(self) >> 32) * (uint64_t) n) >> 32);
+}
+
+float SimRandom_uniform(SimRandom* self, float lo, float hi)
+{
+    return lo + (hi - lo) * ((next64(self) >> 40) * 0x1.0p-24f);
+}
+
+void SimRandom_fillUniform(SimRandom* self, float* out, int count, float lo, float hi)
+{
+    float scale = (hi - lo) * 0x1.0p-24f;
+    int i = 0;
+
+    // two 24 bit samples per 64 bit draw
+    if (self->algorithm == SIM_RANDOM_PCG)
+    {
+        for (; i + 2 <= count; i += 2)
+        {
+            out[i] = lo + (nextPcg(self->s) >> 8) * scale;
+            out[i + 1] = lo + (nextPcg(self->s) >> 8) * scale;
+        }
+    }
+    else
+    {
+        for (; i + 2 <= count; i += 2)
+        {
+            uint64_t x = nextXoshiro(self->s);
+            out[i] = lo + (x >> 40) * scale;
+            out[i + 1] = lo + ((x >> 8) & 0xffffff) * scale;
+        }
+    }
+
+    if (i < count)
+        out[i] = lo + (next64(self) >> 40) * scale;
+}
+
+uint64_t SimRandom_keyed(uint64_t seed, uint64_t counter, uint64_t index)
+{
+    uint64_t key = mix64(seed ^ (counter * 0x9e3779b97f4a7c15ULL));
+    return mix64(key + index * 0xd1b54a32d192ed03ULL);
+}
+
+void SimRandom_fillUniformKeyed(uint64_t seed, uint64_t counter, uint64_t index, float* out, int count, float lo, float hi)
+{
+    uint64_t key = mix64(seed ^ (counter * 0x9e3779b97f4a7c15ULL));
+    float scale = (hi - lo) * 0x1.0p-24f;
+
+    for (int i = 0; i < count; i++)
+        out[i] = lo + (mix64(key + (index + i) * 0xd1b54a32d192ed03ULL) >> 40) * scale;
+}
+
+void SimRandom_fillGaussian(SimRandom* self, float* out, int count, float mean, float sigma)
+{
+    // Box-Muller, pairwise
+    for (int i = 0; i < count; i += 2)
+    {
+        uint64_t x = next64(self);
+        float u1 = ((x >> 40) + 1) * 0x1.0p-24f;           // (0, 1]
+        float u2 = ((x >> 8) & 0xffffff) * 0x1.0p-24f;     // [0, 1)
+
+        float r = sigma * sqrtf(-2.0f * logf(u1));
+        float theta = 2.0f * (float) M_PI * u2;
+
+        out[i] = mean + r * cosf(theta);
+        if (i + 1 < count)
+            out[i + 1] = mean + r * sinf(theta);
+    }
+}
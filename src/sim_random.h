@@ -0,0 +1,51 @@
+#ifndef SIM_RANDOM_H_
+#define SIM_RANDOM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// lock-free pseudo random numbers for the simulation hot path (instead of rand()/random(),
+// which are serialized behind a global lock in glibc and musl)
+typedef enum
+{
+    SIM_RANDOM_XOSHIRO,     // xoshiro256**
+    SIM_RANDOM_PCG          // PCG32 (XSH-RR)
+} SimRandomAlgorithm;
+
+typedef struct
+{
+    SimRandomAlgorithm algorithm;
+    uint64_t s[4];
+    uint64_t generation;
+} SimRandom;
+
+bool SimRandom_parseAlgorithm(const char* name, SimRandomAlgorithm* algorithm);
+const char* SimRandom_getAlgorithmName(SimRandomAlgorithm algorithm);
+
+// algorithm and seed for the per-thread states; threads reseed lazily, each with its own stream
+void SimRandom_configure(SimRandomAlgorithm algorithm, uint64_t seed);
+uint64_t SimRandom_getSeed(void);
+
+// state of the calling thread
+SimRandom* SimRandom_thread(void);
+
+// explicit state for the given seed and stream
+void SimRandom_init(SimRandom* self, SimRandomAlgorithm algorithm, uint64_t seed, uint64_t stream);
+
+uint64_t SimRandom_next(SimRandom* self);
+
+// uniform integer from [0, n)
+uint32_t SimRandom_range(SimRandom* self, uint32_t n);
+
+// uniform float from [lo, hi)
+float SimRandom_uniform(SimRandom* self, float lo, float hi);
+
+void SimRandom_fillUniform(SimRandom* self, float* out, int count, float lo, float hi);
+void SimRandom_fillGaussian(SimRandom* self, float* out, int count, float mean, float sigma);
+
+// counter-based (stateless) variants - the same (seed, counter, index) always yields the same value,
+// independent of the calling thread and of the order of the calls
+uint64_t SimRandom_keyed(uint64_t seed, uint64_t counter, uint64_t index);
+void SimRandom_fillUniformKeyed(uint64_t seed, uint64_t counter, uint64_t index, float* out, int count, float lo, float hi);
+
+#endif /* SIM_RANDOM_H_ */
@@ -0,0 +1,278 @@
+#include "sim_reports.h"
+#include "iec61850_dynamic_model.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define TRIGGERS (TRG_OPT_DATA_CHANGED | TRG_OPT_DATA_UPDATE)
+
+typedef struct
+{
+    char variable[130];         // LN$FC$DO
+    FunctionalConstraint fc;
+    LogicalNode* logicalNode;
+} Fcda;
+
+struct sSimReports
+{
+    IedModel* model;
+
+    // last data set and control block of the model before the generated ones, NULL - none
+    DataSet* lastDataSet;
+    ReportControlBlock* lastReport;
+
+    int dataSetCount;
+    int reportCount;
+
+    Fcda* fcdas;
+    int fcdasCount;
+    int fcdasCapacity;
+    Fcda** members;
+};
+
+bool SimReports_parseGrouping(const char* name, SimReportsGrouping* grouping)
+{
+    if (strcasecmp(name, "none") == 0) *grouping = SIM_REPORTS_NONE;
+    else if (strcasecmp(name, "ln") == 0) *grouping = SIM_REPORTS_BY_LN;
+    else if (strcasecmp(name, "fc") == 0) *grouping = SIM_REPORTS_BY_FC;
+    else return false;
+
+    return true;
+}
+
+const char* SimReports_getGroupingName(SimReportsGrouping grouping)
+{
+    switch (grouping)
+    {
+        case SIM_REPORTS_BY_LN: return "ln";
+        case SIM_REPORTS_BY_FC: return "fc";
+        default: return "none";
+    }
+}
+
+// the data object (or one of its sub data objects) has data of the functional constraint that triggers reports
+static bool hasTriggeredData(ModelNode* dataObject, FunctionalConstraint fc)
+{
+    for (ModelNode* child = dataObject->firstChild; child != NULL; child = child->sibling)
+    {
+        if (child->modelType == DataObjectModelType)
+        {
+            if (hasTriggeredData(child, fc)) return true;
+        }
+        else if (((DataAttribute*) child)->fc == fc && (((DataAttribute*) child)->triggerOptions & TRIGGERS))
+            return true;
+    }
+
+    return false;
+}
+
+static bool addFcda(SimReports self, LogicalNode* logicalNode, ModelNode* dataObject, FunctionalConstraint fc)
+{
+    if (self->fcdasCount == self->fcdasCapacity)
+    {
+        int capacity = (self->fcdasCapacity > 0) ? self->fcdasCapacity * 2 : 256;
+
+        Fcda* fcdas = (Fcda*) realloc(self->fcdas, capacity * sizeof(Fcda));
+        if (fcdas == NULL) return false;
+        self->fcdas = fcdas;
+
+        Fcda** members = (Fcda**) realloc(self->members, capacity * sizeof(Fcda*));
+        if (members == NULL) return false;
+        self->members = members;
+
+        self->fcdasCapacity = capacity;
+    }
+
+    Fcda* fcda = &self->fcdas[self->fcdasCount++];
+    snprintf(fcda->variable, sizeof(fcda->variable), "%s$%s$%s", logicalNode->name, FunctionalConstraint_toString(fc), dataObject->name);
+    fcda->fc = fc;
+    fcda->logicalNode = logicalNode;
+
+    return true;
+}
+
+static void createReport(SimReports self, LogicalNode* host, const char* dataSetName, bool buffered, const SimReportsConfig* config)
+{
+    uint8_t options = RPT_OPT_SEQ_NUM | RPT_OPT_TIME_STAMP | RPT_OPT_REASON_FOR_INCLUSION | RPT_OPT_DATA_SET | RPT_OPT_CONF_REV;
+    if (buffered)
+        options |= RPT_OPT_BUFFER_OVERFLOW | RPT_OPT_ENTRY_ID;
+
+    uint8_t trgOps = TRG_OPT_DATA_CHANGED | TRG_OPT_QUALITY_CHANGED | TRG_OPT_DATA_UPDATE | TRG_OPT_GI;
+    if (config->integrityPeriod > 0)
+        trgOps |= TRG_OPT_INTEGRITY;
+
+    // brcbMX, urcbMMXU1, ... (the data set name without "Sim")
+    int instances = (config->instances > 1) ? config->instances : 1;
+
+    for (int n = 1; n <= instances; n++)
+    {
+        char name[65];
+
+        if (instances > 1)
+            snprintf(name, sizeof(name), "%s%s%02d", buffered ? "brcb" : "urcb", dataSetName + 3, n);
+        else
+            snprintf(name, sizeof(name), "%s%s", buffered ? "brcb" : "urcb", dataSetName + 3);
+
+        ReportControlBlock_create(name, host, NULL, buffered, (char*) dataSetName, 1, trgOps, options, config->bufferTime, config->integrityPeriod);
+        self->reportCount++;
+    }
+}
+
+// data sets of a group, split by the size limit, each one with its control blocks
+static void createGroup(SimReports self, LogicalNode* host, const char* name, int count, const SimReportsConfig* config)
+{
+    int size = (config->dataSetSize > 0) ? config->dataSetSize : count;
+    int chunks = (count + size - 1) / size;
+
+    for (int chunk = 0; chunk < chunks; chunk++)
+    {
+        char dataSetName[65];
+
+        if (chunks > 1)
+            snprintf(dataSetName, sizeof(dataSetName), "%s%02d", name, chunk + 1);
+        else
+            snprintf(dataSetName, sizeof(dataSetName), "%s", name);
+
+        DataSet* dataSet = DataSet_create(dataSetName, host);
+
+        for (int m = chunk * size; m < count && m < (chunk + 1) * size; m++)
+            DataSetEntry_create(dataSet, self->members[m]->variable, -1, NULL);
+
+        self->dataSetCount++;
+
+        if (config->buffered) createReport(self, host, dataSetName, true, config);
+        if (config->unbuffered) createReport(self, host, dataSetName, false, config);
+    }
+}
+
+static void generateLogicalDevice(SimReports self, LogicalDevice* logicalDevice, const SimReportsConfig* config)
+{
+    LogicalNode* host = NULL;
+    self->fcdasCount = 0;
+
+    for (ModelNode* logicalNode = logicalDevice->firstChild; logicalNode != NULL; logicalNode = logicalNode->sibling)
+    {
+        if (host == NULL || strcmp(logicalNode->name, "LLN0") == 0)
+            host = (LogicalNode*) logicalNode;
+
+        for (ModelNode* dataObject = logicalNode->firstChild; dataObject != NULL; dataObject = dataObject->sibling)
+        {
+            if (hasTriggeredData(dataObject, IEC61850_FC_MX) && !addFcda(self, (LogicalNode*) logicalNode, dataObject, IEC61850_FC_MX)) return;
+            if (hasTriggeredData(dataObject, IEC61850_FC_ST) && !addFcda(self, (LogicalNode*) logicalNode, dataObject, IEC61850_FC_ST)) return;
+        }
+    }
+
+    if (config->grouping == SIM_REPORTS_BY_LN)
+    {
+        // FCDAs of a logical node are consecutive
+        for (int first = 0, end; first < self->fcdasCount; first = end)
+        {
+            char name[65];
+            int count = 0;
+
+            for (end = first; end < self->fcdasCount && self->fcdas[end].logicalNode == self->fcdas[first].logicalNode; end++)
+                self->members[count++] = &self->fcdas[end];
+
+            snprintf(name, sizeof(name), "Sim%s", self->fcdas[first].logicalNode->name);
+            createGroup(self, host, name, count, config);
+        }
+    }
+    else
+    {
+        FunctionalConstraint fcs[2] = { IEC61850_FC_MX, IEC61850_FC_ST };
+
+        for (int f = 0; f < 2; f++)
+        {
+            char name[65];
+            int count = 0;
+
+            for (int n = 0; n < self->fcdasCount; n++)
+                if (self->fcdas[n].fc == fcs[f]) self->members[count++] = &self->fcdas[n];
+
+            snprintf(name, sizeof(name), "Sim%s", FunctionalConstraint_toString(fcs[f]));
+            if (count > 0) createGroup(self, host, name, count, config);
+        }
+    }
+}
+
+SimReports SimReports_generate(IedModel* model, const SimReportsConfig* config)
+{
+    if (config->grouping == SIM_REPORTS_NONE || (!config->buffered && !config->unbuffered)) return NULL;
+
+    SimReports self = (SimReports) calloc(1, sizeof(struct sSimReports));
+
+    if (self == NULL) return NULL;
+
+    self->model = model;
+    for (DataSet* dataSet = model->dataSets; dataSet != NULL; dataSet = dataSet->sibling) self->lastDataSet = dataSet;
+    for (ReportControlBlock* rcb = model->rcbs; rcb != NULL; rcb = rcb->sibling) self->lastReport = rcb;
+
+    for (LogicalDevice* logicalDevice = model->firstChild; logicalDevice != NULL; logicalDevice = (LogicalDevice*) logicalDevice->sibling)
+        generateLogicalDevice(self, logicalDevice, config);
+
+    // only needed while generating
+    free(self->fcdas);
+    free(self->members);
+    self->fcdas = NULL;
+    self->members = NULL;
+
+    return self;
+}
+
+int SimReports_getDataSetCount(SimReports self)
+{
+    return (self != NULL) ? self->dataSetCount : 0;
+}
+
+int SimReports_getReportCount(SimReports self)
+{
+    return (self != NULL) ? self->reportCount : 0;
+}
+
+void SimReports_destroy(SimReports self)
+{
+    if (self == NULL) return;
+
+    // allocated by the dynamic model API, released as IedModel_destroy does
+    DataSet** dataSets = (self->lastDataSet != NULL) ? &self->lastDataSet->sibling : &self->model->dataSets;
+    DataSet* dataSet = *dataSets;
+    *dataSets = NULL;
+
+    while (dataSet != NULL)
+    {
+        DataSet* next = dataSet->sibling;
+
+        for (DataSetEntry* entry = dataSet->fcdas; entry != NULL; )
+        {
+            DataSetEntry* nextEntry = entry->sibling;
+
+            free(entry->variableName);
+            free(entry->componentName);
+            if (entry->isLDNameDynamicallyAllocated) free(entry->logicalDeviceName);
+            free(entry);
+            entry = nextEntry;
+        }
+
+        free(dataSet->name);
+        free(dataSet);
+        dataSet = next;
+    }
+
+    ReportControlBlock** rcbs = (self->lastReport != NULL) ? &self->lastReport->sibling : &self->model->rcbs;
+    ReportControlBlock* rcb = *rcbs;
+    *rcbs = NULL;
+
+    while (rcb != NULL)
+    {
+        ReportControlBlock* next = rcb->sibling;
+
+        free(rcb->name);
+        free(rcb->rptId);
+        free(rcb->dataSetName);
+        free(rcb);
+        rcb = next;
+    }
+
+    free(self);
+}
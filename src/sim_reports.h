@@ -0,0 +1,45 @@
+#ifndef SIM_REPORTS_H_
+#define SIM_REPORTS_H_
+
+#include "iec61850_model.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// data sets and report control blocks synthesized over the simulated data of a model (i.e. for models without
+// preconfigured reports) - one FCDA per data object with MX or ST data that has a data change or data update
+// trigger, grouped per logical node or per functional constraint of a logical device, hosted by LLN0
+typedef enum
+{
+    SIM_REPORTS_NONE,
+    SIM_REPORTS_BY_LN,          // data set Sim<LN> per logical node
+    SIM_REPORTS_BY_FC           // data sets SimMX and SimST per logical device
+} SimReportsGrouping;
+
+typedef struct
+{
+    SimReportsGrouping grouping;
+    int dataSetSize;            // maximum FCDAs per data set, larger groups are split (<name>01, <name>02, ...)
+    bool buffered;              // brcb<name> per data set
+    bool unbuffered;            // urcb<name> per data set
+    int instances;              // instances of each control block (one per client), named <rcb>01, <rcb>02, ...
+    uint32_t bufferTime;        // BufTm [ms]
+    uint32_t integrityPeriod;   // IntgPd [ms], 0 - no integrity reports
+} SimReportsConfig;
+
+// "none", "ln" or "fc"
+bool SimReports_parseGrouping(const char* name, SimReportsGrouping* grouping);
+const char* SimReports_getGroupingName(SimReportsGrouping grouping);
+
+// data sets and control blocks added to a model, before a server is created for it
+typedef struct sSimReports* SimReports;
+
+// NULL - nothing generated (or out of memory)
+SimReports SimReports_generate(IedModel* model, const SimReportsConfig* config);
+
+int SimReports_getDataSetCount(SimReports self);
+int SimReports_getReportCount(SimReports self);
+
+// removes the generated data sets and control blocks from the model - after the server is destroyed
+void SimReports_destroy(SimReports self);
+
+#endif /* SIM_REPORTS_H_ */
@@ -0,0 +1,256 @@
+#include "sim_scheduler.h"
+#include "hal_time.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+
+// backlog the burst policy is allowed to catch up on, anything older is skipped
+#ifndef SCHEDULER_MAX_BURST_NS
+    #define SCHEDULER_MAX_BURST_NS 1000000000ULL
+#endif
+
+struct sSimScheduler
+{
+    uint64_t periodNs;
+    SimCatchUpPolicy policy;
+    bool virtualClock;
+
+    SimIdleHandler idleHandler;
+    void* idleParameter;
+
+    uint64_t startNs;
+    uint64_t deadlineNs;    // absolute deadline of the next tick
+    uint64_t tickNs;        // absolute deadline of the current tick
+    uint64_t tickIndex;
+    uint64_t nextIndex;
+
+    // statistics (since last report)
+    uint64_t ticks;
+    uint64_t overruns;
+    uint64_t skipped;
+    uint64_t coalesced;
+    int64_t jitterMin;
+    int64_t jitterMax;
+    double jitterSum;
+    double jitterSumSq;
+};
+
+static void sleepUntil(SimScheduler self, uint64_t deadlineNs)
+{
+    uint64_t now = Hal_getTimeInNs();
+
+    // overrun - the idle handler still gets its turn once per tick
+    if (self->idleHandler != NULL && now >= deadlineNs)
+        self->idleHandler(self->idleParameter, 0);
+
+    while (now < deadlineNs)
+    {
+        uint64_t remaining = deadlineNs - now;
+
+        // whole milliseconds are handed to the idle handler, the rest is slept
+        if (self->idleHandler != NULL && remaining >= 1000000ULL)
+        {
+            self->idleHandler(self->idleParameter, (uint32_t)(remaining / 1000000ULL));
+            now = Hal_getTimeInNs();
+            continue;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = remaining / 1000000000ULL;
+        ts.tv_nsec = remaining % 1000000000ULL;
+
+        if (nanosleep(&ts, NULL) != 0 && errno != EINTR)
+            break;
+
+        now = Hal_getTimeInNs();
+    }
+}
+
+static void resetStatistics(SimScheduler self)
+{
+    self->ticks = 0;
+    self->overruns = 0;
+    self->skipped = 0;
+    self->coalesced = 0;
+    self->jitterMin = INT64_MAX;
+    self->jitterMax = INT64_MIN;
+    self->jitterSum = 0.0;
+    self->jitterSumSq = 0.0;
+}
+
+SimScheduler SimScheduler_create(uint64_t periodNs, SimCatchUpPolicy policy)
+{
+    SimScheduler self = (SimScheduler) calloc(1, sizeof(struct sSimScheduler));
+
+    if (self == NULL) return NULL;
+
+    self->periodNs = (periodNs > 0) ? periodNs : 1;
+    self->policy = policy;
+    self->startNs = Hal_getTimeInNs();
+    self->deadlineNs = self->startNs;
+    self->tickNs = self->deadlineNs;
+    self->tickIndex = 0;
+    self->nextIndex = 0;
+
+    resetStatistics(self);
+
+    return self;
+}
+
+void SimScheduler_destroy(SimScheduler self)
+{
+    free(self);
+}
+
+void SimScheduler_setVirtualClock(SimScheduler self, bool enabled)
+{
+    self->virtualClock = enabled;
+}
+
+void SimScheduler_setIdleHandler(SimScheduler self, SimIdleHandler handler, void* parameter)
+{
+    self->idleHandler = handler;
+    self->idleParameter = parameter;
+}
+
+uint32_t SimScheduler_waitNextTick(SimScheduler self)
+{
+    uint64_t now = self->deadlineNs;
+
+    if (!self->virtualClock)
+    {
+        sleepUntil(self, self->deadlineNs);
+        now = Hal_getTimeInNs();
+    }
+    else if (self->idleHandler != NULL)
+        self->idleHandler(self->idleParameter, 0);
+
+    int64_t lateness = (int64_t)(now - self->deadlineNs);
+
+    if (lateness < self->jitterMin) self->jitterMin = lateness;
+    if (lateness > self->jitterMax) self->jitterMax = lateness;
+    self->jitterSum += (double) lateness;
+    self->jitterSumSq += (double) lateness * (double) lateness;
+    self->ticks++;
+
+    uint32_t periods = 1;
+    uint64_t missed = (lateness > 0) ? (uint64_t) lateness / self->periodNs : 0;
+
+    if (missed > 0)
+    {
+        self->overruns++;
+
+        switch (self->policy)
+        {
+            case SIM_CATCHUP_SKIP:
+                self->skipped += missed;
+                self->deadlineNs += missed * self->periodNs;
+                self->nextIndex += missed;
+            break;
+
+            case SIM_CATCHUP_BURST:
+            {
+                // leave the deadline in the past so the following ticks return immediately
+                uint64_t maxBacklog = SCHEDULER_MAX_BURST_NS / self->periodNs;
+                if (missed > maxBacklog)
+                {
+                    uint64_t dropped = missed - maxBacklog;
+                    self->skipped += dropped;
+                    self->deadlineNs += dropped * self->periodNs;
+                    self->nextIndex += dropped;
+                }
+            }
+            break;
+
+            case SIM_CATCHUP_COALESCE:
+                if (missed > UINT32_MAX - 1) missed = UINT32_MAX - 1;
+                self->coalesced += missed;
+                self->deadlineNs += missed * self->periodNs;
+                self->nextIndex += missed;
+                periods += (uint32_t) missed;
+            break;
+        }
+    }
+
+    self->tickNs = self->deadlineNs;
+    self->tickIndex = self->nextIndex;
+
+    self->deadlineNs += self->periodNs;
+    self->nextIndex++;
+
+    return periods;
+}
+
+uint64_t SimScheduler_getTickTime(SimScheduler self)
+{
+    return self->tickNs;
+}
+
+uint64_t SimScheduler_getStartTime(SimScheduler self)
+{
+    return self->startNs;
+}
+
+uint64_t SimScheduler_getTickIndex(SimScheduler self)
+{
+    return self->tickIndex;
+}
+
+uint64_t SimScheduler_getPeriod(SimScheduler self)
+{
+    return self->periodNs;
+}
+
+void SimScheduler_getStatistics(SimScheduler self, SimSchedulerStatistics* statistics)
+{
+    statistics->ticks = self->ticks;
+    statistics->overruns = self->overruns;
+    statistics->skipped = self->skipped;
+    statistics->coalesced = self->coalesced;
+
+    if (self->ticks > 0)
+    {
+        double mean = self->jitterSum / self->ticks;
+        double variance = self->jitterSumSq / self->ticks - mean * mean;
+
+        statistics->jitterMinNs = self->jitterMin;
+        statistics->jitterMaxNs = self->jitterMax;
+        statistics->jitterMeanNs = mean;
+        statistics->jitterStdDevNs = (variance > 0.0) ? sqrt(variance) : 0.0;
+    }
+    else
+    {
+        statistics->jitterMinNs = 0;
+        statistics->jitterMaxNs = 0;
+        statistics->jitterMeanNs = 0.0;
+        statistics->jitterStdDevNs = 0.0;
+    }
+
+    resetStatistics(self);
+}
+
+bool SimScheduler_parsePolicy(const char* name, SimCatchUpPolicy* policy)
+{
+    if (name == NULL) return false;
+
+    if (strcasecmp(name, "skip") == 0) *policy = SIM_CATCHUP_SKIP;
+    else if (strcasecmp(name, "burst") == 0) *policy = SIM_CATCHUP_BURST;
+    else if (strcasecmp(name, "coalesce") == 0) *policy = SIM_CATCHUP_COALESCE;
+    else return false;
+
+    return true;
+}
+
+const char* SimScheduler_getPolicyName(SimCatchUpPolicy policy)
+{
+    switch (policy)
+    {
+        case SIM_CATCHUP_SKIP: return "skip";
+        case SIM_CATCHUP_BURST: return "burst";
+        case SIM_CATCHUP_COALESCE: return "coalesce";
+    }
+    return "?";
+}
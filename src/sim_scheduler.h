@@ -0,0 +1,61 @@
+#ifndef SIM_SCHEDULER_H_
+#define SIM_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// what to do when a tick starts after one or more later deadlines already passed
+typedef enum
+{
+    SIM_CATCHUP_SKIP,       // drop the missed ticks, resume on the next deadline in the future
+    SIM_CATCHUP_BURST,      // run the missed ticks back-to-back until caught up
+    SIM_CATCHUP_COALESCE    // run one tick that accounts for all missed periods
+} SimCatchUpPolicy;
+
+typedef struct
+{
+    uint64_t ticks;         // ticks delivered
+    uint64_t overruns;      // ticks that started after the following deadline
+    uint64_t skipped;       // periods dropped (skip, or burst backlog above the limit)
+    uint64_t coalesced;     // periods merged into a single tick
+    int64_t jitterMinNs;    // wake-up lateness relative to the deadline
+    int64_t jitterMaxNs;
+    double jitterMeanNs;
+    double jitterStdDevNs;
+} SimSchedulerStatistics;
+
+typedef struct sSimScheduler* SimScheduler;
+
+// called instead of sleeping while waiting for the next deadline - has to return within timeoutMs
+typedef void (*SimIdleHandler)(void* parameter, uint32_t timeoutMs);
+
+SimScheduler SimScheduler_create(uint64_t periodNs, SimCatchUpPolicy policy);
+void SimScheduler_destroy(SimScheduler self);
+
+// virtual clock - ticks follow each other without sleeping, tick times still advance by one period
+void SimScheduler_setVirtualClock(SimScheduler self, bool enabled);
+
+// idle handler (i.e. network I/O of a threadless server) run while waiting for the deadlines
+void SimScheduler_setIdleHandler(SimScheduler self, SimIdleHandler handler, void* parameter);
+
+// blocks until the next deadline and returns the number of periods the tick accounts for
+uint32_t SimScheduler_waitNextTick(SimScheduler self);
+
+// deadline [ns] of the current tick
+uint64_t SimScheduler_getTickTime(SimScheduler self);
+
+// time [ns] of the first tick
+uint64_t SimScheduler_getStartTime(SimScheduler self);
+
+// index of the current tick in periods since start (drives simulation time)
+uint64_t SimScheduler_getTickIndex(SimScheduler self);
+
+uint64_t SimScheduler_getPeriod(SimScheduler self);
+
+// copies statistics collected since the previous call and resets them
+void SimScheduler_getStatistics(SimScheduler self, SimSchedulerStatistics* statistics);
+
+bool SimScheduler_parsePolicy(const char* name, SimCatchUpPolicy* policy);
+const char* SimScheduler_getPolicyName(SimCatchUpPolicy policy);
+
+#endif /* SIM_SCHEDULER_H_ */
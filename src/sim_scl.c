@@ -0,0 +1,816 @@
+#include "sim_scl.h"
+#include "iec61850_dynamic_model.h"
+#include "mms_value.h"
+#include <libxml/xmlreader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// the SCL file is read in a single streaming pass (the data type templates usually come after the IEDs),
+// keeping only the selected IED and the templates in compact records - other IEDs, substation and
+// communication sections of an SCD are skipped without being materialized; the model is built afterwards
+
+#define POOL_BLOCK_SIZE (64 * 1024)
+#define TYPES_HASH_SIZE 4096
+#define MAX_PATH_DEPTH 16
+
+// bump allocator for the records of one load, released at once
+typedef struct sPoolBlock
+{
+    struct sPoolBlock* next;
+    size_t used;
+    size_t size;
+    char data[];
+} PoolBlock;
+
+typedef struct
+{
+    PoolBlock* blocks;
+} Pool;
+
+typedef enum { ENTRY_DO, ENTRY_SDO, ENTRY_DA, ENTRY_BDA, ENTRY_ENUMVAL } EntryKind;
+typedef enum { TYPE_LNODE, TYPE_DO, TYPE_DA, TYPE_ENUM } TypeKind;
+
+typedef struct sSclEntry
+{
+    EntryKind kind;
+    const char* name;           // EnumVal - its text
+    const char* type;
+    const char* bType;
+    const char* fc;
+    const char* value;          // Val
+    uint8_t triggerOptions;
+    int count;
+    int ord;
+    struct sSclEntry* next;
+} SclEntry;
+
+typedef struct sSclType
+{
+    TypeKind kind;
+    const char* id;
+    SclEntry* first;
+    SclEntry* last;
+    struct sSclType* nextInBucket;
+} SclType;
+
+typedef struct sSclValue
+{
+    const char* path;           // DOI[.SDI...].DAI
+    const char* value;
+    struct sSclValue* next;
+} SclValue;
+
+typedef struct sSclFcda
+{
+    const char* variable;       // MMS variable name
+    struct sSclFcda* next;
+} SclFcda;
+
+typedef struct sSclDataSet
+{
+    const char* name;
+    SclFcda* first;
+    SclFcda* last;
+    struct sSclDataSet* next;
+} SclDataSet;
+
+typedef struct sSclReport
+{
+    const char* name;
+    const char* rptId;
+    const char* dataSet;
+    bool buffered;
+    uint32_t confRev;
+    uint32_t bufTime;
+    uint32_t intgPd;
+    uint8_t trgOps;
+    uint8_t options;
+    int instances;
+    struct sSclReport* next;
+} SclReport;
+
+typedef struct sSclLogicalNode
+{
+    const char* name;
+    const char* lnType;
+    SclValue* firstValue;
+    SclValue* lastValue;
+    SclDataSet* firstDataSet;
+    SclDataSet* lastDataSet;
+    SclReport* firstReport;
+    SclReport* lastReport;
+    int actSG;                  // SettingControl, numOfSGs 0 - none
+    int numOfSGs;
+    struct sSclLogicalNode* next;
+} SclLogicalNode;
+
+typedef struct sSclDevice
+{
+    const char* inst;
+    SclLogicalNode* first;
+    SclLogicalNode* last;
+    struct sSclDevice* next;
+} SclDevice;
+
+typedef struct
+{
+    Pool pool;
+    SclType* types[TYPES_HASH_SIZE];
+
+    const char* iedName;
+    SclDevice* firstDevice;
+    SclDevice* lastDevice;
+
+    // parser state
+    bool inIed;
+    bool iedFound;
+    SclDevice* device;
+    SclLogicalNode* logicalNode;
+    SclDataSet* dataSet;
+    SclReport* report;
+    SclType* type;
+    SclEntry* entry;
+
+    char path[256];
+    int pathLengths[MAX_PATH_DEPTH];
+    int pathDepth;
+    bool valueRead;             // the current DAI has a value
+} SclParser;
+
+static void* poolAlloc(Pool* pool, size_t size)
+{
+    size = (size + 7) & ~(size_t) 7;
+
+    if (pool->blocks == NULL || pool->blocks->used + size > pool->blocks->size)
+    {
+        size_t blockSize = (size > POOL_BLOCK_SIZE) ? size : POOL_BLOCK_SIZE;
+        PoolBlock* block = (PoolBlock*) malloc(sizeof(PoolBlock) + blockSize);
+        if (block == NULL) return NULL;
+
+        block->next = pool->blocks;
+        block->used = 0;
+        block->size = blockSize;
+        pool->blocks = block;
+    }
+
+    void* memory = pool->blocks->data + pool->blocks->used;
+    pool->blocks->used += size;
+    memset(memory, 0, size);
+    return memory;
+}
+
+static const char* poolString(Pool* pool, const xmlChar* string)
+{
+    if (string == NULL) return NULL;
+
+    size_t length = strlen((const char*) string);
+    char* copy = (char*) poolAlloc(pool, length + 1);
+    if (copy != NULL) memcpy(copy, string, length + 1);
+    return copy;
+}
+
+static void poolFree(Pool* pool)
+{
+    while (pool->blocks != NULL)
+    {
+        PoolBlock* next = pool->blocks->next;
+        free(pool->blocks);
+        pool->blocks = next;
+    }
+}
+
+static unsigned hashString(const char* string)
+{
+    unsigned hash = 2166136261u;
+    while (*string) hash = (hash ^ (unsigned char) *string++) * 16777619u;
+    return hash;
+}
+
+static SclType* findType(SclParser* parser, TypeKind kind, const char* id)
+{
+    if (id == NULL) return NULL;
+
+    for (SclType* type = parser->types[hashString(id) % TYPES_HASH_SIZE]; type != NULL; type = type->nextInBucket)
+        if (type->kind == kind && strcmp(type->id, id) == 0)
+            return type;
+
+    return NULL;
+}
+
+static SclEntry* findEntry(SclType* type, const char* name)
+{
+    for (SclEntry* entry = (type != NULL) ? type->first : NULL; entry != NULL; entry = entry->next)
+        if (entry->name != NULL && strcmp(entry->name, name) == 0)
+            return entry;
+
+    return NULL;
+}
+
+// attribute of the current element, copied into the pool (NULL if not present)
+static const char* readAttribute(SclParser* parser, xmlTextReaderPtr reader, const char* name)
+{
+    xmlChar* value = xmlTextReaderGetAttribute(reader, BAD_CAST name);
+    const char* copy = poolString(&parser->pool, value);
+    xmlFree(value);
+    return copy;
+}
+
+static bool readFlag(xmlTextReaderPtr reader, const char* name, bool fallback)
+{
+    xmlChar* value = xmlTextReaderGetAttribute(reader, BAD_CAST name);
+    bool flag = (value == NULL) ? fallback : (strcmp((const char*) value, "true") == 0);
+    xmlFree(value);
+    return flag;
+}
+
+static long readNumber(xmlTextReaderPtr reader, const char* name, long fallback)
+{
+    xmlChar* value = xmlTextReaderGetAttribute(reader, BAD_CAST name);
+    long number = (value == NULL) ? fallback : strtol((const char*) value, NULL, 10);
+    xmlFree(value);
+    return number;
+}
+
+static uint8_t readTriggerOptions(xmlTextReaderPtr reader)
+{
+    uint8_t options = 0;
+
+    if (readFlag(reader, "dchg", false)) options |= TRG_OPT_DATA_CHANGED;
+    if (readFlag(reader, "qchg", false)) options |= TRG_OPT_QUALITY_CHANGED;
+    if (readFlag(reader, "dupd", false)) options |= TRG_OPT_DATA_UPDATE;
+
+    return options;
+}
+
+static const char* readText(SclParser* parser, xmlTextReaderPtr reader)
+{
+    xmlChar* text = xmlTextReaderReadString(reader);
+    const char* copy = poolString(&parser->pool, text);
+    xmlFree(text);
+    return copy;
+}
+
+static bool is(const xmlChar* name, const char* element)
+{
+    return strcmp((const char*) name, element) == 0;
+}
+
+static void pushPath(SclParser* parser, const char* name)
+{
+    int length = (parser->pathDepth > 0) ? parser->pathLengths[parser->pathDepth - 1] : 0;
+
+    if (parser->pathDepth < MAX_PATH_DEPTH)
+    {
+        int written = snprintf(parser->path + length, sizeof(parser->path) - length, "%s%s", (length > 0) ? "." : "", name ? name : "");
+        if (written < 0 || length + written >= (int) sizeof(parser->path)) written = 0;
+        parser->pathLengths[parser->pathDepth] = length + written;
+    }
+    parser->pathDepth++;
+}
+
+static void popPath(SclParser* parser)
+{
+    if (parser->pathDepth > 0) parser->pathDepth--;
+
+    int length = (parser->pathDepth > 0 && parser->pathDepth <= MAX_PATH_DEPTH) ? parser->pathLengths[parser->pathDepth - 1] : 0;
+    parser->path[length] = 0;
+}
+
+static void startType(SclParser* parser, xmlTextReaderPtr reader, TypeKind kind)
+{
+    SclType* type = (SclType*) poolAlloc(&parser->pool, sizeof(SclType));
+    type->kind = kind;
+    type->id = readAttribute(parser, reader, "id");
+
+    if (type->id == NULL) return;
+
+    unsigned bucket = hashString(type->id) % TYPES_HASH_SIZE;
+    type->nextInBucket = parser->types[bucket];
+    parser->types[bucket] = type;
+
+    parser->type = type;
+}
+
+static void addEntry(SclParser* parser, xmlTextReaderPtr reader, EntryKind kind)
+{
+    SclEntry* entry = (SclEntry*) poolAlloc(&parser->pool, sizeof(SclEntry));
+    entry->kind = kind;
+
+    if (kind == ENTRY_ENUMVAL)
+    {
+        entry->ord = (int) readNumber(reader, "ord", 0);
+        entry->name = readText(parser, reader);
+    }
+    else
+    {
+        entry->name = readAttribute(parser, reader, "name");
+        entry->type = readAttribute(parser, reader, "type");
+        entry->bType = readAttribute(parser, reader, "bType");
+        entry->fc = readAttribute(parser, reader, "fc");
+        entry->count = (int) readNumber(reader, "count", 0);
+        entry->triggerOptions = readTriggerOptions(reader);
+    }
+
+    if (parser->type->last != NULL) parser->type->last->next = entry; else parser->type->first = entry;
+    parser->type->last = entry;
+
+    parser->entry = entry;
+}
+
+static void startLogicalNode(SclParser* parser, xmlTextReaderPtr reader)
+{
+    xmlChar* prefix = xmlTextReaderGetAttribute(reader, BAD_CAST "prefix");
+    xmlChar* lnClass = xmlTextReaderGetAttribute(reader, BAD_CAST "lnClass");
+    xmlChar* inst = xmlTextReaderGetAttribute(reader, BAD_CAST "inst");
+
+    char name[65];
+    snprintf(name, sizeof(name), "%s%s%s", prefix ? (char*) prefix : "", lnClass ? (char*) lnClass : "", inst ? (char*) inst : "");
+
+    xmlFree(prefix);
+    xmlFree(lnClass);
+    xmlFree(inst);
+
+    SclLogicalNode* logicalNode = (SclLogicalNode*) poolAlloc(&parser->pool, sizeof(SclLogicalNode));
+    logicalNode->name = poolString(&parser->pool, BAD_CAST name);
+    logicalNode->lnType = readAttribute(parser, reader, "lnType");
+
+    if (parser->device->last != NULL) parser->device->last->next = logicalNode; else parser->device->first = logicalNode;
+    parser->device->last = logicalNode;
+
+    parser->logicalNode = logicalNode;
+    parser->pathDepth = 0;
+    parser->path[0] = 0;
+}
+
+static void addFcda(SclParser* parser, xmlTextReaderPtr reader)
+{
+    xmlChar* ldInst = xmlTextReaderGetAttribute(reader, BAD_CAST "ldInst");
+    xmlChar* prefix = xmlTextReaderGetAttribute(reader, BAD_CAST "prefix");
+    xmlChar* lnClass = xmlTextReaderGetAttribute(reader, BAD_CAST "lnClass");
+    xmlChar* lnInst = xmlTextReaderGetAttribute(reader, BAD_CAST "lnInst");
+    xmlChar* doName = xmlTextReaderGetAttribute(reader, BAD_CAST "doName");
+    xmlChar* daName = xmlTextReaderGetAttribute(reader, BAD_CAST "daName");
+    xmlChar* fc = xmlTextReaderGetAttribute(reader, BAD_CAST "fc");
+
+    if (lnClass != NULL && doName != NULL && fc != NULL)
+    {
+        // MMS variable name - [LD/]LN$FC$DO[$DA], "." replaced by "$"
+        char variable[256];
+        int length = 0;
+
+        if (ldInst != NULL && strcmp((char*) ldInst, parser->device->inst) != 0)
+            length += snprintf(variable + length, sizeof(variable) - length, "%s/", (char*) ldInst);
+        length += snprintf(variable + length, sizeof(variable) - length, "%s%s%s$%s$%s",
+            prefix ? (char*) prefix : "", (char*) lnClass, lnInst ? (char*) lnInst : "", (char*) fc, (char*) doName);
+        if (daName != NULL && length < (int) sizeof(variable))
+            snprintf(variable + length, sizeof(variable) - length, "$%s", (char*) daName);
+
+        for (char* c = variable; *c; c++)
+            if (*c == '.') *c = '$';
+
+        SclFcda* fcda = (SclFcda*) poolAlloc(&parser->pool, sizeof(SclFcda));
+        fcda->variable = poolString(&parser->pool, BAD_CAST variable);
+
+        if (parser->dataSet->last != NULL) parser->dataSet->last->next = fcda; else parser->dataSet->first = fcda;
+        parser->dataSet->last = fcda;
+    }
+
+    xmlFree(ldInst);
+    xmlFree(prefix);
+    xmlFree(lnClass);
+    xmlFree(lnInst);
+    xmlFree(doName);
+    xmlFree(daName);
+    xmlFree(fc);
+}
+
+static void startReport(SclParser* parser, xmlTextReaderPtr reader)
+{
+    SclReport* report = (SclReport*) poolAlloc(&parser->pool, sizeof(SclReport));
+
+    report->name = readAttribute(parser, reader, "name");
+    report->rptId = readAttribute(parser, reader, "rptID");
+    report->dataSet = readAttribute(parser, reader, "datSet");
+    report->buffered = readFlag(reader, "buffered", false);
+    report->confRev = (uint32_t) readNumber(reader, "confRev", 0);
+    report->bufTime = (uint32_t) readNumber(reader, "bufTime", 0);
+    report->intgPd = (uint32_t) readNumber(reader, "intgPd", 0);
+    report->trgOps = TRG_OPT_GI;
+    report->instances = 1;
+
+    if (report->name == NULL) return;
+
+    SclLogicalNode* logicalNode = parser->logicalNode;
+    if (logicalNode->lastReport != NULL) logicalNode->lastReport->next = report; else logicalNode->firstReport = report;
+    logicalNode->lastReport = report;
+
+    parser->report = report;
+}
+
+// element start (within the selected IED or the data type templates); returns false to skip its subtree
+static bool startElement(SclParser* parser, xmlTextReaderPtr reader, const xmlChar* name)
+{
+    if (is(name, "Private") || is(name, "Substation") || is(name, "Communication") || is(name, "Header"))
+        return false;
+
+    if (is(name, "IED"))
+    {
+        xmlChar* iedName = xmlTextReaderGetAttribute(reader, BAD_CAST "name");
+        bool selected = (parser->firstDevice == NULL && !parser->inIed) &&
+                        (parser->iedName == NULL || (iedName != NULL && strcmp((char*) iedName, parser->iedName) == 0));
+
+        if (selected)
+        {
+            parser->inIed = true;
+            parser->iedFound = true;
+            parser->iedName = poolString(&parser->pool, iedName ? iedName : BAD_CAST "IED");
+        }
+        xmlFree(iedName);
+        return selected;
+    }
+
+    if (parser->inIed)
+    {
+        if (is(name, "LDevice"))
+        {
+            SclDevice* device = (SclDevice*) poolAlloc(&parser->pool, sizeof(SclDevice));
+            device->inst = readAttribute(parser, reader, "inst");
+            if (device->inst == NULL) return false;
+
+            if (parser->lastDevice != NULL) parser->lastDevice->next = device; else parser->firstDevice = device;
+            parser->lastDevice = device;
+            parser->device = device;
+        }
+        else if ((is(name, "LN0") || is(name, "LN")) && parser->device != NULL)
+            startLogicalNode(parser, reader);
+        else if (parser->logicalNode != NULL)
+        {
+            if (is(name, "DOI") || is(name, "SDI") || is(name, "DAI"))
+            {
+                xmlChar* nodeName = xmlTextReaderGetAttribute(reader, BAD_CAST "name");
+                pushPath(parser, (char*) nodeName);
+                xmlFree(nodeName);
+                parser->valueRead = false;
+            }
+            else if (is(name, "Val") && parser->pathDepth > 0)
+            {
+                // setting groups (sGroup) - the first value, as the model was loaded before
+                if (parser->valueRead) return false;
+                parser->valueRead = true;
+
+                SclValue* value = (SclValue*) poolAlloc(&parser->pool, sizeof(SclValue));
+                value->path = poolString(&parser->pool, BAD_CAST parser->path);
+                value->value = readText(parser, reader);
+
+                SclLogicalNode* logicalNode = parser->logicalNode;
+                if (logicalNode->lastValue != NULL) logicalNode->lastValue->next = value; else logicalNode->firstValue = value;
+                logicalNode->lastValue = value;
+                return false;
+            }
+            else if (is(name, "DataSet"))
+            {
+                SclDataSet* dataSet = (SclDataSet*) poolAlloc(&parser->pool, sizeof(SclDataSet));
+                dataSet->name = readAttribute(parser, reader, "name");
+                if (dataSet->name == NULL) return false;
+
+                SclLogicalNode* logicalNode = parser->logicalNode;
+                if (logicalNode->lastDataSet != NULL) logicalNode->lastDataSet->next = dataSet; else logicalNode->firstDataSet = dataSet;
+                logicalNode->lastDataSet = dataSet;
+                parser->dataSet = dataSet;
+            }
+            else if (is(name, "FCDA") && parser->dataSet != NULL)
+                addFcda(parser, reader);
+            else if (is(name, "ReportControl"))
+                startReport(parser, reader);
+            else if (is(name, "TrgOps") && parser->report != NULL)
+            {
+                parser->report->trgOps = readTriggerOptions(reader);
+                if (readFlag(reader, "period", false)) parser->report->trgOps |= TRG_OPT_INTEGRITY;
+                if (readFlag(reader, "gi", true)) parser->report->trgOps |= TRG_OPT_GI;
+            }
+            else if (is(name, "OptFields") && parser->report != NULL)
+            {
+                uint8_t options = 0;
+                if (readFlag(reader, "seqNum", false)) options |= RPT_OPT_SEQ_NUM;
+                if (readFlag(reader, "timeStamp", false)) options |= RPT_OPT_TIME_STAMP;
+                if (readFlag(reader, "reasonCode", false)) options |= RPT_OPT_REASON_FOR_INCLUSION;
+                if (readFlag(reader, "dataSet", false)) options |= RPT_OPT_DATA_SET;
+                if (readFlag(reader, "dataRef", false)) options |= RPT_OPT_DATA_REFERENCE;
+                if (readFlag(reader, "bufOvfl", false)) options |= RPT_OPT_BUFFER_OVERFLOW;
+                if (readFlag(reader, "entryID", false)) options |= RPT_OPT_ENTRY_ID;
+                if (readFlag(reader, "configRef", false)) options |= RPT_OPT_CONF_REV;
+                parser->report->options = options;
+            }
+            else if (is(name, "RptEnabled") && parser->report != NULL)
+                parser->report->instances = (int) readNumber(reader, "max", 1);
+            else if (is(name, "SettingControl"))
+            {
+                parser->logicalNode->actSG = (int) readNumber(reader, "actSG", 1);
+                parser->logicalNode->numOfSGs = (int) readNumber(reader, "numOfSGs", 1);
+            }
+        }
+        return true;
+    }
+
+    // data type templates
+    if (is(name, "LNodeType")) startType(parser, reader, TYPE_LNODE);
+    else if (is(name, "DOType")) startType(parser, reader, TYPE_DO);
+    else if (is(name, "DAType")) startType(parser, reader, TYPE_DA);
+    else if (is(name, "EnumType")) startType(parser, reader, TYPE_ENUM);
+    else if (parser->type != NULL)
+    {
+        if (is(name, "DO")) addEntry(parser, reader, ENTRY_DO);
+        else if (is(name, "SDO")) addEntry(parser, reader, ENTRY_SDO);
+        else if (is(name, "DA")) addEntry(parser, reader, ENTRY_DA);
+        else if (is(name, "BDA")) addEntry(parser, reader, ENTRY_BDA);
+        else if (is(name, "EnumVal")) { addEntry(parser, reader, ENTRY_ENUMVAL); return false; }
+        else if (is(name, "Val") && parser->entry != NULL) { parser->entry->value = readText(parser, reader); return false; }
+    }
+
+    return true;
+}
+
+static void endElement(SclParser* parser, const xmlChar* name)
+{
+    if (is(name, "IED") && parser->inIed) parser->inIed = false;
+    else if (is(name, "LDevice")) parser->device = NULL;
+    else if (is(name, "LN0") || is(name, "LN")) parser->logicalNode = NULL;
+    else if (is(name, "DOI") || is(name, "SDI") || is(name, "DAI")) popPath(parser);
+    else if (is(name, "DataSet")) parser->dataSet = NULL;
+    else if (is(name, "ReportControl")) parser->report = NULL;
+    else if (is(name, "LNodeType") || is(name, "DOType") || is(name, "DAType") || is(name, "EnumType")) { parser->type = NULL; parser->entry = NULL; }
+    else if (is(name, "DO") || is(name, "SDO") || is(name, "DA") || is(name, "BDA")) parser->entry = NULL;
+}
+
+static bool parseFile(SclParser* parser, const char* filename)
+{
+    xmlTextReaderPtr reader = xmlReaderForFile(filename, NULL, XML_PARSE_NOBLANKS | XML_PARSE_HUGE | XML_PARSE_COMPACT);
+
+    if (reader == NULL) return false;
+
+    int result = xmlTextReaderRead(reader);
+    while (result == 1)
+    {
+        bool descend = true;
+        int nodeType = xmlTextReaderNodeType(reader);
+        const xmlChar* name = xmlTextReaderConstLocalName(reader);
+
+        if (nodeType == XML_READER_TYPE_ELEMENT)
+        {
+            descend = startElement(parser, reader, name);
+
+            // an empty element has no end element
+            if (descend && xmlTextReaderIsEmptyElement(reader))
+                endElement(parser, name);
+        }
+        else if (nodeType == XML_READER_TYPE_END_ELEMENT)
+            endElement(parser, name);
+
+        result = descend ? xmlTextReaderRead(reader) : xmlTextReaderNext(reader);
+    }
+
+    xmlFreeTextReader(reader);
+
+    return result == 0;
+}
+
+static DataAttributeType parseBasicType(const char* bType)
+{
+    static const struct { const char* name; DataAttributeType type; } types[] = {
+        { "BOOLEAN", IEC61850_BOOLEAN }, { "INT8", IEC61850_INT8 }, { "INT16", IEC61850_INT16 },
+        { "INT32", IEC61850_INT32 }, { "INT64", IEC61850_INT64 }, { "INT128", IEC61850_INT128 },
+        { "INT8U", IEC61850_INT8U }, { "INT16U", IEC61850_INT16U }, { "INT24U", IEC61850_INT24U },
+        { "INT32U", IEC61850_INT32U }, { "FLOAT32", IEC61850_FLOAT32 }, { "FLOAT64", IEC61850_FLOAT64 },
+        { "Enum", IEC61850_ENUMERATED }, { "Dbpos", IEC61850_CODEDENUM }, { "Tcmd", IEC61850_CODEDENUM },
+        { "Quality", IEC61850_QUALITY }, { "Timestamp", IEC61850_TIMESTAMP },
+        { "VisString32", IEC61850_VISIBLE_STRING_32 }, { "VisString64", IEC61850_VISIBLE_STRING_64 },
+        { "VisString65", IEC61850_VISIBLE_STRING_65 }, { "VisString129", IEC61850_VISIBLE_STRING_129 },
+        { "ObjRef", IEC61850_VISIBLE_STRING_129 }, { "VisString255", IEC61850_VISIBLE_STRING_255 },
+        { "Unicode255", IEC61850_UNICODE_STRING_255 }, { "Octet64", IEC61850_OCTET_STRING_64 },
+        { "Octet6", IEC61850_OCTET_STRING_6 }, { "Octet8", IEC61850_OCTET_STRING_8 },
+        { "Check", IEC61850_CHECK }, { "Struct", IEC61850_CONSTRUCTED }, { "EntryTime", IEC61850_ENTRY_TIME },
+        { "PhyComAddr", IEC61850_PHYCOMADDR }, { "Currency", IEC61850_CURRENCY },
+        { "OptFlds", IEC61850_OPTFLDS }, { "TrgOps", IEC61850_TRGOPS }
+    };
+
+    if (bType != NULL)
+        for (unsigned t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+            if (strcmp(types[t].name, bType) == 0)
+                return types[t].type;
+
+    return IEC61850_VISIBLE_STRING_255;
+}
+
+// initial value from the text of a Val element, NULL if the type has no simple text form
+static MmsValue* parseValue(SclParser* parser, DataAttributeType type, const char* enumType, const char* text)
+{
+    switch (type)
+    {
+        case IEC61850_BOOLEAN:
+            return MmsValue_newBoolean(strcasecmp(text, "true") == 0 || strcmp(text, "1") == 0);
+        case IEC61850_INT8: return MmsValue_newIntegerFromInt8((int8_t) atoi(text));
+        case IEC61850_INT16: return MmsValue_newIntegerFromInt16((int16_t) atoi(text));
+        case IEC61850_INT32: return MmsValue_newIntegerFromInt32((int32_t) atol(text));
+        case IEC61850_INT64: return MmsValue_newIntegerFromInt64(atoll(text));
+        case IEC61850_INT8U:
+        case IEC61850_INT16U:
+        case IEC61850_INT24U:
+        case IEC61850_INT32U: return MmsValue_newUnsignedFromUint32((uint32_t) strtoul(text, NULL, 10));
+        case IEC61850_FLOAT32: return MmsValue_newFloat((float) atof(text));
+        case IEC61850_FLOAT64: return MmsValue_newDouble(atof(text));
+        case IEC61850_VISIBLE_STRING_32:
+        case IEC61850_VISIBLE_STRING_64:
+        case IEC61850_VISIBLE_STRING_65:
+        case IEC61850_VISIBLE_STRING_129:
+        case IEC61850_VISIBLE_STRING_255: return MmsValue_newVisibleString(text);
+        case IEC61850_UNICODE_STRING_255: return MmsValue_newMmsString((char*) text);
+        case IEC61850_ENUMERATED:
+        {
+            // by the name of the enumeration value, or by its ordinal
+            SclEntry* enumValue = findEntry(findType(parser, TYPE_ENUM, enumType), text);
+            return MmsValue_newIntegerFromInt32((enumValue != NULL) ? enumValue->ord : atoi(text));
+        }
+        default:
+            return NULL;
+    }
+}
+
+static void setValue(SclParser* parser, DataAttribute* dataAttribute, const char* enumType, const char* text)
+{
+    if (text == NULL || dataAttribute == NULL || dataAttribute->modelType != DataAttributeModelType || dataAttribute->type == IEC61850_CONSTRUCTED)
+        return;
+
+    MmsValue* value = parseValue(parser, dataAttribute->type, enumType, text);
+
+    if (value != NULL)
+    {
+        DataAttribute_setValue(dataAttribute, value);
+        MmsValue_delete(value);
+    }
+}
+
+// DA of a DOType or BDA of a DAType - sub attributes inherit FC and trigger options
+static void createDataAttribute(SclParser* parser, SclEntry* entry, ModelNode* parent, FunctionalConstraint fc, uint8_t triggerOptions)
+{
+    DataAttributeType type = parseBasicType(entry->bType);
+
+    if (entry->name == NULL) return;
+
+    if (entry->kind == ENTRY_DA)
+    {
+        fc = (entry->fc != NULL) ? FunctionalConstraint_fromString(entry->fc) : IEC61850_FC_NONE;
+        triggerOptions = entry->triggerOptions;
+    }
+
+    DataAttribute* dataAttribute = DataAttribute_create(entry->name, parent, type, fc, triggerOptions, entry->count, 0);
+
+    if (type == IEC61850_CONSTRUCTED)
+    {
+        SclType* daType = findType(parser, TYPE_DA, entry->type);
+
+        for (SclEntry* child = (daType != NULL) ? daType->first : NULL; child != NULL; child = child->next)
+            if (child->kind == ENTRY_BDA)
+                createDataAttribute(parser, child, (ModelNode*) dataAttribute, fc, triggerOptions);
+    }
+    else
+        setValue(parser, dataAttribute, entry->type, entry->value);
+}
+
+static void createDataObject(SclParser* parser, SclEntry* entry, ModelNode* parent)
+{
+    SclType* doType = findType(parser, TYPE_DO, entry->type);
+
+    if (doType == NULL || entry->name == NULL)
+    {
+        printf("Warning - SCL data object type '%s' of '%s' not found\n", entry->type ? entry->type : "", entry->name ? entry->name : "");
+        return;
+    }
+
+    DataObject* dataObject = DataObject_create(entry->name, parent, entry->count);
+
+    for (SclEntry* child = doType->first; child != NULL; child = child->next)
+    {
+        if (child->kind == ENTRY_SDO)
+            createDataObject(parser, child, (ModelNode*) dataObject);
+        else if (child->kind == ENTRY_DA)
+            createDataAttribute(parser, child, (ModelNode*) dataObject, IEC61850_FC_NONE, 0);
+    }
+}
+
+// instance value - walks the path through the model and the data type templates side by side
+static void applyInstanceValue(SclParser* parser, SclValue* value, LogicalNode* logicalNode, SclType* lnType)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s", value->path);
+
+    ModelNode* node = (ModelNode*) logicalNode;
+    SclType* type = lnType;
+    SclEntry* entry = NULL;
+    char* saveptr = NULL;
+
+    for (char* name = strtok_r(path, ".", &saveptr); name != NULL; name = strtok_r(NULL, ".", &saveptr))
+    {
+        node = ModelNode_getChild(node, name);
+        if (node == NULL) return;
+
+        entry = findEntry(type, name);
+        if (entry == NULL)
+            type = NULL;
+        else if (entry->kind == ENTRY_DO || entry->kind == ENTRY_SDO)
+            type = findType(parser, TYPE_DO, entry->type);
+        else
+            type = findType(parser, TYPE_DA, entry->type);
+    }
+
+    setValue(parser, (DataAttribute*) node, (entry != NULL) ? entry->type : NULL, value->value);
+}
+
+static void createLogicalNode(SclParser* parser, SclLogicalNode* sclNode, LogicalDevice* logicalDevice)
+{
+    SclType* lnType = findType(parser, TYPE_LNODE, sclNode->lnType);
+    if (lnType == NULL)
+    {
+        printf("Warning - SCL logical node type '%s' of '%s' not found\n", sclNode->lnType ? sclNode->lnType : "", sclNode->name);
+        return;
+    }
+
+    LogicalNode* logicalNode = LogicalNode_create(sclNode->name, logicalDevice);
+
+    for (SclEntry* entry = lnType->first; entry != NULL; entry = entry->next)
+        if (entry->kind == ENTRY_DO)
+            createDataObject(parser, entry, (ModelNode*) logicalNode);
+
+    for (SclValue* value = sclNode->firstValue; value != NULL; value = value->next)
+        applyInstanceValue(parser, value, logicalNode, lnType);
+
+    for (SclDataSet* sclDataSet = sclNode->firstDataSet; sclDataSet != NULL; sclDataSet = sclDataSet->next)
+    {
+        DataSet* dataSet = DataSet_create(sclDataSet->name, logicalNode);
+
+        for (SclFcda* fcda = sclDataSet->first; fcda != NULL; fcda = fcda->next)
+            DataSetEntry_create(dataSet, fcda->variable, -1, NULL);
+    }
+
+    // RptEnabled max - instances of the control block, named <name>01, <name>02, ...
+    for (SclReport* report = sclNode->firstReport; report != NULL; report = report->next)
+    {
+        int instances = (report->instances > 1) ? report->instances : 1;
+
+        for (int n = 1; n <= instances; n++)
+        {
+            char rcbName[130];
+
+            if (instances > 1)
+                snprintf(rcbName, sizeof(rcbName), "%s%02d", report->name, n);
+            else
+                snprintf(rcbName, sizeof(rcbName), "%s", report->name);
+
+            ReportControlBlock_create(rcbName, logicalNode, (report->rptId != NULL && report->rptId[0]) ? (char*) report->rptId : NULL, report->buffered,
+                (report->dataSet != NULL && report->dataSet[0]) ? (char*) report->dataSet : NULL, report->confRev,
+                report->trgOps, report->options, report->bufTime, report->intgPd);
+        }
+    }
+
+    if (sclNode->numOfSGs > 0)
+        SettingGroupControlBlock_create(logicalNode, sclNode->actSG, sclNode->numOfSGs);
+}
+
+IedModel* SimScl_loadModel(const char* filename, const char* iedName)
+{
+    SclParser* parser = (SclParser*) calloc(1, sizeof(SclParser));
+
+    if (parser == NULL) return NULL;
+
+    parser->iedName = iedName;
+
+    IedModel* model = NULL;
+    bool parsed = parseFile(parser, filename);
+
+    // no IED of the name (i.e. the TEMPLATE of an ICD) - the first IED of the file
+    if (parsed && !parser->iedFound && iedName != NULL)
+    {
+        poolFree(&parser->pool);
+        memset(parser, 0, sizeof(SclParser));
+        parsed = parseFile(parser, filename);
+    }
+
+    if (parsed && parser->firstDevice != NULL)
+    {
+        model = IedModel_create(parser->iedName);
+
+        for (SclDevice* device = parser->firstDevice; device != NULL; device = device->next)
+        {
+            LogicalDevice* logicalDevice = LogicalDevice_create(device->inst, model);
+
+            for (SclLogicalNode* logicalNode = device->first; logicalNode != NULL; logicalNode = logicalNode->next)
+                createLogicalNode(parser, logicalNode, logicalDevice);
+        }
+    }
+
+    poolFree(&parser->pool);
+    free(parser);
+
+    return model;
+}
@@ -0,0 +1,10 @@
+#ifndef SIM_SCL_H_
+#define SIM_SCL_H_
+
+#include "iec61850_model.h"
+
+// builds a dynamic model from an SCL file (ICD, CID, IID or SCD) at runtime;
+// iedName selects the IED of an SCD, NULL (or no IED of the name) - the first IED of the file
+IedModel* SimScl_loadModel(const char* filename, const char* iedName);
+
+#endif /* SIM_SCL_H_ */
@@ -0,0 +1,363 @@
+#define _GNU_SOURCE
+#include "sim_sv.h"
+#include "sv_publisher.h"
+#include "hal_thread.h"
+#include "hal_time.h"
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+
+// 9-2LE data set - TCTR1..4 (phase currents, neutral), TVTR1..4 (phase voltages, neutral)
+#define CHANNELS 8
+
+// 9-2LE scaling - 1 mA, 10 mV
+#define CURRENT_SCALE 1000.0
+#define VOLTAGE_SCALE 100.0
+
+struct sSimSv
+{
+    SimSvConfig config;
+    char interface[64];
+    char svId[130];
+
+    int rate;                   // samples/s
+    int32_t* table;             // one nominal cycle, CHANNELS per sample
+
+    SVPublisher publisher;
+    SVPublisher_ASDU asdus[SIM_SV_MAX_ASDUS];
+    int valueIndex[CHANNELS];   // the same in every ASDU
+    int qualityIndex[CHANNELS];
+
+    uint64_t startNs;           // sample 0, a whole second
+    bool running;
+    Thread thread;
+
+    // statistics, shared with the thread
+    Semaphore statisticsLock;
+    uint64_t statisticsNs;
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t skipped;
+    uint64_t intervals;
+    int64_t jitterMin;
+    int64_t jitterMax;
+    double jitterSum;
+    double jitterSumSq;
+    bool realtime;
+};
+
+bool SimSv_parseWave(const char* text, SimSvWave* wave)
+{
+    SimSvWave parsed = { 0.0f, 0.0f, 0.0f };
+
+    if (sscanf(text, "%f,%f,%f", &parsed.A, &parsed.B, &parsed.D) < 2) return false;
+
+    *wave = parsed;
+    return true;
+}
+
+int SimSv_parseHarmonics(const char* text, SimSvHarmonic* harmonics, int max)
+{
+    int count = 0;
+
+    while (*text != 0)
+    {
+        int consumed = 0;
+
+        if (count == max || sscanf(text, " %d:%f%n", &harmonics[count].order, &harmonics[count].amplitude, &consumed) != 2 ||
+            harmonics[count].order < 2)
+            return -1;
+
+        count++;
+        text += consumed;
+        if (*text == ',') text++;
+    }
+
+    return count;
+}
+
+static int32_t scale(double value, double scale)
+{
+    double scaled = round(value * scale);
+
+    if (scaled > INT32_MAX) return INT32_MAX;
+    if (scaled < INT32_MIN) return INT32_MIN;
+
+    return (int32_t) scaled;
+}
+
+static double evaluate(const SimSvConfig* config, const SimSvWave* wave, double angle)
+{
+    double value = wave->A + wave->B * sin(angle);
+
+    for (int h = 0; h < config->harmonicsCount; h++)
+        value += config->harmonics[h].amplitude * wave->B * sin(config->harmonics[h].order * angle);
+
+    return value;
+}
+
+// the waveforms are periodic in the nominal cycle (whole harmonics) - the samples are read from a table of one cycle
+static bool createTable(SimSv self)
+{
+    int samples = self->config.samplesPerCycle;
+
+    self->table = (int32_t*) malloc(samples * CHANNELS * sizeof(int32_t));
+
+    if (self->table == NULL) return false;
+
+    for (int s = 0; s < samples; s++)
+    {
+        int32_t* row = &self->table[s * CHANNELS];
+        int64_t currents = 0;
+        int64_t voltages = 0;
+
+        for (int phase = 0; phase < 3; phase++)
+        {
+            double angle = 2.0 * M_PI * s / samples - phase * 2.0 * M_PI / 3.0;
+
+            row[phase] = scale(evaluate(&self->config, &self->config.current, angle + self->config.current.D), CURRENT_SCALE);
+            row[4 + phase] = scale(evaluate(&self->config, &self->config.voltage, angle + self->config.voltage.D), VOLTAGE_SCALE);
+
+            currents += row[phase];
+            voltages += row[4 + phase];
+        }
+
+        // neutrals - sum of the phases
+        row[3] = scale((double) currents, 1.0);
+        row[7] = scale((double) voltages, 1.0);
+    }
+
+    return true;
+}
+
+// deadline of a sample [ns] - exact for rates that do not divide a second into whole nanoseconds
+static uint64_t getDeadline(SimSv self, uint64_t sample)
+{
+    return self->startNs + (sample / self->rate) * 1000000000ULL + (sample % self->rate) * 1000000000ULL / self->rate;
+}
+
+// the last sample due at a time
+static uint64_t getSample(SimSv self, uint64_t time)
+{
+    uint64_t elapsed = time - self->startNs;
+
+    return (elapsed / 1000000000ULL) * self->rate + (elapsed % 1000000000ULL) * self->rate / 1000000000ULL;
+}
+
+static void* publisherThread(void* parameter)
+{
+    SimSv self = (SimSv) parameter;
+    int asdus = self->config.asdus;
+    double nominal = 1e9 * asdus / self->rate;
+
+    // the default timer slack alone delays a wake-up by up to 50 us
+    prctl(PR_SET_TIMERSLACK, 1UL);
+
+    // with CAP_SYS_NICE
+    struct sched_param scheduling = { .sched_priority = sched_get_priority_min(SCHED_FIFO) + 10 };
+    self->realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &scheduling) == 0);
+
+    uint64_t sample = 0;
+    uint64_t previous = 0;
+
+    while (__atomic_load_n(&self->running, __ATOMIC_RELAXED))
+    {
+        uint64_t deadline = getDeadline(self, sample);
+        struct timespec wakeup = { deadline / 1000000000ULL, deadline % 1000000000ULL };
+
+        while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &wakeup, NULL) == EINTR);
+
+        uint64_t now = Hal_getTimeInNs();
+
+        // late beyond the next frame - the frames in between are dropped, the stream stays on the clock
+        uint64_t skipped = 0;
+        if (now >= getDeadline(self, sample + asdus))
+        {
+            uint64_t current = getSample(self, now) / asdus * asdus;
+            skipped = current - sample;
+            sample = current;
+        }
+
+        for (int a = 0; a < asdus; a++)
+        {
+            const int32_t* row = &self->table[((sample + a) % self->config.samplesPerCycle) * CHANNELS];
+
+            for (int c = 0; c < CHANNELS; c++)
+                SVPublisher_ASDU_setINT32(self->asdus[a], self->valueIndex[c], row[c]);
+
+            SVPublisher_ASDU_setSmpCnt(self->asdus[a], (uint16_t) ((sample + a) % self->rate));
+        }
+
+        uint64_t sent = Hal_getTimeInNs();
+        SVPublisher_publish(self->publisher);
+
+        Semaphore_wait(self->statisticsLock);
+
+        self->frames++;
+        self->samples += asdus;
+        self->skipped += skipped;
+
+        if (previous != 0 && skipped == 0)
+        {
+            int64_t jitter = (int64_t) (sent - previous) - (int64_t) nominal;
+
+            if (jitter < self->jitterMin) self->jitterMin = jitter;
+            if (jitter > self->jitterMax) self->jitterMax = jitter;
+            self->jitterSum += (double) jitter;
+            self->jitterSumSq += (double) jitter * (double) jitter;
+            self->intervals++;
+        }
+
+        Semaphore_post(self->statisticsLock);
+
+        previous = sent;
+        sample += asdus;
+    }
+
+    return NULL;
+}
+
+static void resetStatistics(SimSv self)
+{
+    self->frames = 0;
+    self->samples = 0;
+    self->skipped = 0;
+    self->intervals = 0;
+    self->jitterMin = INT64_MAX;
+    self->jitterMax = INT64_MIN;
+    self->jitterSum = 0.0;
+    self->jitterSumSq = 0.0;
+}
+
+SimSv SimSv_create(const SimSvConfig* config)
+{
+    SimSv self = (SimSv) calloc(1, sizeof(struct sSimSv));
+
+    if (self == NULL) return NULL;
+
+    self->config = *config;
+    snprintf(self->interface, sizeof(self->interface), "%s", config->interface);
+    snprintf(self->svId, sizeof(self->svId), "%s", config->svId);
+    self->config.interface = self->interface;
+    self->config.svId = self->svId;
+
+    if (self->config.samplesPerCycle <= 0) self->config.samplesPerCycle = 80;
+    if (self->config.frequency <= 0) self->config.frequency = 50;
+    if (self->config.asdus <= 0) self->config.asdus = 1;
+    if (self->config.asdus > SIM_SV_MAX_ASDUS) self->config.asdus = SIM_SV_MAX_ASDUS;
+
+    self->rate = self->config.samplesPerCycle * self->config.frequency;
+    resetStatistics(self);
+
+    CommParameters parameters;
+    parameters.vlanPriority = config->vlanPriority;
+    parameters.vlanId = config->vlanId;
+    parameters.appId = config->appId;
+    memcpy(parameters.dstAddress, config->dstAddress, 6);
+
+    self->statisticsLock = Semaphore_create(1);
+
+    if (self->statisticsLock == NULL || !createTable(self) ||
+        (self->publisher = SVPublisher_createEx(&parameters, self->interface, config->vlan)) == NULL)
+    {
+        SimSv_destroy(self);
+        return NULL;
+    }
+
+    for (int a = 0; a < self->config.asdus; a++)
+    {
+        self->asdus[a] = SVPublisher_addASDU(self->publisher, self->svId, NULL, 1);
+
+        for (int c = 0; c < CHANNELS; c++)
+        {
+            self->valueIndex[c] = SVPublisher_ASDU_addINT32(self->asdus[a]);
+            self->qualityIndex[c] = SVPublisher_ASDU_addQuality(self->asdus[a]);
+        }
+    }
+
+    SVPublisher_setupComplete(self->publisher);
+
+    for (int a = 0; a < self->config.asdus; a++)
+        for (int c = 0; c < CHANNELS; c++)
+            SVPublisher_ASDU_setQuality(self->asdus[a], self->qualityIndex[c], QUALITY_VALIDITY_GOOD);
+
+    return self;
+}
+
+void SimSv_destroy(SimSv self)
+{
+    if (self == NULL) return;
+
+    // the thread wakes up every frame
+    __atomic_store_n(&self->running, false, __ATOMIC_RELAXED);
+
+    if (self->thread != NULL)
+        Thread_destroy(self->thread);
+
+    if (self->publisher != NULL) SVPublisher_destroy(self->publisher);
+    if (self->statisticsLock != NULL) Semaphore_destroy(self->statisticsLock);
+    free(self->table);
+    free(self);
+}
+
+bool SimSv_start(SimSv self)
+{
+    // sample 0 on the next whole second
+    self->startNs = (Hal_getTimeInNs() / 1000000000ULL + 1) * 1000000000ULL;
+    self->statisticsNs = self->startNs;
+    self->running = true;
+
+    self->thread = Thread_create(publisherThread, self, false);
+
+    if (self->thread == NULL) return false;
+
+    Thread_start(self->thread);
+    return true;
+}
+
+int SimSv_getSampleRate(SimSv self)
+{
+    return self->rate;
+}
+
+void SimSv_getStatistics(SimSv self, SimSvStatistics* statistics)
+{
+    uint64_t now = Hal_getTimeInNs();
+
+    Semaphore_wait(self->statisticsLock);
+
+    statistics->frames = self->frames;
+    statistics->samples = self->samples;
+    statistics->skipped = self->skipped;
+    statistics->rate = (now > self->statisticsNs) ? 1e9 * self->samples / (now - self->statisticsNs) : 0.0;
+    statistics->realtime = self->realtime;
+
+    if (self->intervals > 0)
+    {
+        double mean = self->jitterSum / self->intervals;
+        double variance = self->jitterSumSq / self->intervals - mean * mean;
+
+        statistics->jitterMinNs = self->jitterMin;
+        statistics->jitterMaxNs = self->jitterMax;
+        statistics->jitterMeanNs = mean;
+        statistics->jitterStdDevNs = (variance > 0.0) ? sqrt(variance) : 0.0;
+    }
+    else
+    {
+        statistics->jitterMinNs = 0;
+        statistics->jitterMaxNs = 0;
+        statistics->jitterMeanNs = 0.0;
+        statistics->jitterStdDevNs = 0.0;
+    }
+
+    resetStatistics(self);
+    self->statisticsNs = now;
+
+    Semaphore_post(self->statisticsLock);
+}
@@ -0,0 +1,80 @@
+#ifndef SIM_SV_H_
+#define SIM_SV_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sampled Values publisher (IEC 61850-9-2LE) - three phase currents and voltages (plus neutrals) synthesized from the
+// coefficients of the simulation function and harmonics into tables of one nominal cycle, published by a thread of
+// its own on absolute deadlines aligned to the second of the system clock (SmpCnt is the sample in the second)
+
+#define SIM_SV_MAX_HARMONICS 16
+#define SIM_SV_MAX_ASDUS 8
+
+// A + B sin(C t + D) of phase A [A or V], C = 2 pi frequency; phases B and C lag by 120 and 240 degrees
+typedef struct
+{
+    float A;
+    float B;
+    float D;
+} SimSvWave;
+
+typedef struct
+{
+    int order;                  // multiple of the frequency
+    float amplitude;            // relative to B
+} SimSvHarmonic;
+
+typedef struct
+{
+    const char* interface;      // Ethernet interface, i.e. "eth0"
+    bool vlan;                  // VLAN tagged frames
+    uint16_t vlanId;
+    uint8_t vlanPriority;
+    uint16_t appId;
+    uint8_t dstAddress[6];
+    const char* svId;
+    int frequency;              // nominal [Hz]
+    int samplesPerCycle;        // 80 - 4000/4800 samples/s at 50/60 Hz
+    int asdus;                  // ASDUs (consecutive samples) per frame
+    SimSvWave current;
+    SimSvWave voltage;
+    SimSvHarmonic harmonics[SIM_SV_MAX_HARMONICS];
+    int harmonicsCount;
+} SimSvConfig;
+
+// since the last call of SimSv_getStatistics
+typedef struct
+{
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t skipped;           // samples whose frames were too late to be sent
+    double rate;                // samples/s sustained
+    int64_t jitterMinNs;        // inter-frame interval relative to the nominal one
+    int64_t jitterMaxNs;
+    double jitterMeanNs;
+    double jitterStdDevNs;
+    bool realtime;              // the publisher thread runs with a real-time priority
+} SimSvStatistics;
+
+typedef struct sSimSv* SimSv;
+
+// "A,B" or "A,B,D"
+bool SimSv_parseWave(const char* text, SimSvWave* wave);
+
+// "order:amplitude,...", i.e. "3:0.05,5:0.02" - number of harmonics, -1 - invalid
+int SimSv_parseHarmonics(const char* text, SimSvHarmonic* harmonics, int max);
+
+// NULL - the interface can not be opened (or out of memory)
+SimSv SimSv_create(const SimSvConfig* config);
+
+// stops the thread
+void SimSv_destroy(SimSv self);
+
+bool SimSv_start(SimSv self);
+
+int SimSv_getSampleRate(SimSv self);
+
+void SimSv_getStatistics(SimSv self, SimSvStatistics* statistics);
+
+#endif /* SIM_SV_H_ */
@@ -0,0 +1,194 @@
+#include "sim_visitor.h"
+#include <stdlib.h>
+
+// pending siblings of one level of the walk, with the context inherited by them
+typedef struct
+{
+    ModelNode* node;
+    DataAttribute* quality;
+    DataAttribute* timestamp;
+    DataAttribute* top;             // functional constraint level attribute, NULL - children of a data object
+} Frame;
+
+typedef struct
+{
+    Frame* frames;
+    int depth;
+    int capacity;
+
+    SimLeaf* leaves;
+    int count;
+    int leavesCapacity;
+
+    bool failed;
+} Walk;
+
+static void push(Walk* walk, ModelNode* node, DataAttribute* quality, DataAttribute* timestamp, DataAttribute* top)
+{
+    if (node == NULL) return;
+
+    if (walk->depth == walk->capacity)
+    {
+        int capacity = (walk->capacity > 0) ? walk->capacity * 2 : 32;
+        Frame* frames = (Frame*) realloc(walk->frames, capacity * sizeof(Frame));
+        if (frames == NULL)
+        {
+            walk->failed = true;
+            return;
+        }
+        walk->frames = frames;
+        walk->capacity = capacity;
+    }
+
+    Frame* frame = &walk->frames[walk->depth++];
+    frame->node = node;
+    frame->quality = quality;
+    frame->timestamp = timestamp;
+    frame->top = top;
+}
+
+static void addLeaf(Walk* walk, Frame* frame, DataAttribute* value, int element, LogicalDevice* logicalDevice, LogicalNode* logicalNode)
+{
+    if (walk->count == walk->leavesCapacity)
+    {
+        int capacity = (walk->leavesCapacity > 0) ? walk->leavesCapacity * 2 : 1024;
+        SimLeaf* leaves = (SimLeaf*) realloc(walk->leaves, capacity * sizeof(SimLeaf));
+        if (leaves == NULL)
+        {
+            walk->failed = true;
+            return;
+        }
+        walk->leaves = leaves;
+        walk->leavesCapacity = capacity;
+    }
+
+    SimLeaf* leaf = &walk->leaves[walk->count++];
+    leaf->value = value;
+    leaf->element = element;
+    leaf->quality = frame->quality;
+    leaf->timestamp = frame->timestamp;
+    leaf->logicalDevice = logicalDevice;
+    leaf->logicalNode = logicalNode;
+}
+
+static bool isSimulatable(DataAttributeType type)
+{
+    switch (type)
+    {
+        case IEC61850_BOOLEAN:
+        case IEC61850_INT8:
+        case IEC61850_INT16:
+        case IEC61850_INT32:
+        case IEC61850_INT64:
+        case IEC61850_INT8U:
+        case IEC61850_INT16U:
+        case IEC61850_INT24U:
+        case IEC61850_INT32U:
+        case IEC61850_FLOAT32:
+        case IEC61850_FLOAT64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void visitDataAttribute(Walk* walk, Frame* frame, DataAttribute* dataAttribute, LogicalDevice* logicalDevice, LogicalNode* logicalNode)
+{
+    DataAttribute* top = (frame->top != NULL) ? frame->top : dataAttribute;
+
+    if (!(top->triggerOptions & (TRG_OPT_DATA_CHANGED | TRG_OPT_DATA_UPDATE)))
+        return;
+
+    if (dataAttribute->type == IEC61850_CONSTRUCTED)
+    {
+        // elements of an array of constructed attributes have no model nodes of their own
+        if (dataAttribute->elementCount == 0)
+            push(walk, dataAttribute->firstChild, frame->quality, frame->timestamp, top);
+        return;
+    }
+
+    // only attributes bound to the value cache of the server can be updated
+    if (!isSimulatable(dataAttribute->type) || dataAttribute->mmsValue == NULL || frame->timestamp == NULL)
+        return;
+
+    if (dataAttribute->elementCount > 0)
+        for (int element = 0; element < dataAttribute->elementCount; element++)
+            addLeaf(walk, frame, dataAttribute, element, logicalDevice, logicalNode);
+    else
+        addLeaf(walk, frame, dataAttribute, -1, logicalDevice, logicalNode);
+}
+
+SimLeaf* SimVisitor_collectLeaves(IedModel* model, int* count)
+{
+    Walk walk = { 0 };
+    LogicalDevice* logicalDevice = NULL;
+    LogicalNode* logicalNode = NULL;
+
+    push(&walk, (ModelNode*) model->firstChild, NULL, NULL, NULL);
+
+    while (walk.depth > 0 && !walk.failed)
+    {
+        Frame* frame = &walk.frames[walk.depth - 1];
+        ModelNode* node = frame->node;
+
+        if (node == NULL)
+        {
+            walk.depth--;
+            continue;
+        }
+        frame->node = node->sibling;
+
+        // the frame is copied - pushing may move the stack
+        Frame context = *frame;
+
+        switch (node->modelType)
+        {
+            case LogicalDeviceModelType:
+                logicalDevice = (LogicalDevice*) node;
+                push(&walk, node->firstChild, NULL, NULL, NULL);
+                break;
+
+            case LogicalNodeModelType:
+                logicalNode = (LogicalNode*) node;
+                push(&walk, node->firstChild, NULL, NULL, NULL);
+                break;
+
+            case DataObjectModelType:
+            {
+                // own quality and timestamp, or the ones of the enclosing data object
+                DataAttribute* quality = NULL;
+                DataAttribute* timestamp = NULL;
+
+                for (ModelNode* child = node->firstChild; child != NULL; child = child->sibling)
+                {
+                    if (child->modelType != DataAttributeModelType) continue;
+                    if (((DataAttribute*) child)->type == IEC61850_QUALITY) quality = (DataAttribute*) child;
+                    if (((DataAttribute*) child)->type == IEC61850_TIMESTAMP) timestamp = (DataAttribute*) child;
+                }
+
+                if (quality == NULL && timestamp == NULL)
+                {
+                    quality = context.quality;
+                    timestamp = context.timestamp;
+                }
+                push(&walk, node->firstChild, quality, timestamp, NULL);
+                break;
+            }
+
+            case DataAttributeModelType:
+                visitDataAttribute(&walk, &context, (DataAttribute*) node, logicalDevice, logicalNode);
+                break;
+        }
+    }
+
+    free(walk.frames);
+
+    if (walk.failed)
+    {
+        free(walk.leaves);
+        return NULL;
+    }
+
+    *count = walk.count;
+    return (walk.leaves != NULL) ? walk.leaves : (SimLeaf*) calloc(1, sizeof(SimLeaf));
+}
@@ -0,0 +1,23 @@
+#ifndef SIM_VISITOR_H_
+#define SIM_VISITOR_H_
+
+#include "iec61850_model.h"
+
+// simulatable leaf of the model - a basic type (boolean, integer or floating point) data attribute, or an element
+// of such an array, below a data attribute with data change or data update trigger and bound to a value;
+// quality and timestamp are the ones of the closest data object that has them
+typedef struct
+{
+    DataAttribute* value;
+    int element;                    // array element, -1 - not an array
+    DataAttribute* quality;         // NULL - none
+    DataAttribute* timestamp;
+    LogicalDevice* logicalDevice;
+    LogicalNode* logicalNode;
+} SimLeaf;
+
+// walks the whole model iteratively (nested data objects, constructed attributes and arrays) and returns
+// the table of all leaves with a timestamp in model order, released with free(); NULL - out of memory
+SimLeaf* SimVisitor_collectLeaves(IedModel* model, int* count);
+
+#endif /* SIM_VISITOR_H_ */
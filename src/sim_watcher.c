@@ -0,0 +1,192 @@
+#include "sim_watcher.h"
+#include "hal_thread.h"
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// quiet time after the last event of a file before it is reported [ms]
+#define SETTLE_TIME 50
+
+#define FILE_EVENTS (IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF)
+#define DIRECTORY_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+
+typedef struct
+{
+    char* path;
+    const char* name;               // in path
+    int fileWatch;                  // -1 - the file is gone (or was replaced), watched again when it reappears
+    int directoryWatch;             // -1 - none (i.e. a file mounted on its own)
+    bool changed;
+} WatchedFile;
+
+struct sSimWatcher
+{
+    SimWatcherHandler handler;
+    void* parameter;
+
+    int inotify;
+    int wakeup[2];                  // pipe to stop the thread (by closing it)
+    Thread thread;
+
+    WatchedFile* files;
+    int count;
+};
+
+static void watchFile(SimWatcher self, WatchedFile* file)
+{
+    file->fileWatch = inotify_add_watch(self->inotify, file->path, FILE_EVENTS);
+}
+
+static void handleEvent(SimWatcher self, struct inotify_event* event)
+{
+    for (int f = 0; f < self->count; f++)
+    {
+        WatchedFile* file = &self->files[f];
+
+        if (event->wd == file->fileWatch)
+        {
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+                file->fileWatch = -1;
+            if (event->mask & IN_CLOSE_WRITE)
+                file->changed = true;
+        }
+        else if (event->wd == file->directoryWatch && event->len > 0 && strcmp(event->name, file->name) == 0)
+        {
+            // a new file under the name
+            if (event->mask & (IN_MOVED_TO | IN_CREATE))
+                watchFile(self, file);
+            file->changed |= (event->mask & (IN_MOVED_TO | IN_CLOSE_WRITE)) != 0;
+        }
+    }
+}
+
+static void* watcherThread(void* parameter)
+{
+    SimWatcher self = (SimWatcher) parameter;
+    char buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool pending = false;
+
+    while (true)
+    {
+        struct pollfd fds[2] = { { self->inotify, POLLIN, 0 }, { self->wakeup[0], POLLIN, 0 } };
+
+        int ready = poll(fds, 2, pending ? SETTLE_TIME : -1);
+
+        if (ready < 0) continue;
+        if (fds[1].revents) break;
+
+        if (ready == 0)
+        {
+            // settled
+            pending = false;
+            for (int f = 0; f < self->count; f++)
+            {
+                if (!self->files[f].changed) continue;
+
+                self->files[f].changed = false;
+                self->handler(self->parameter, f);
+            }
+            continue;
+        }
+
+        ssize_t length = read(self->inotify, buffer, sizeof(buffer));
+
+        for (char* event = buffer; length > 0 && event < buffer + length; event += sizeof(struct inotify_event) + ((struct inotify_event*) event)->len)
+            handleEvent(self, (struct inotify_event*) event);
+
+        for (int f = 0; f < self->count; f++)
+            pending |= self->files[f].changed;
+    }
+
+    return NULL;
+}
+
+SimWatcher SimWatcher_create(SimWatcherHandler handler, void* parameter)
+{
+    SimWatcher self = (SimWatcher) calloc(1, sizeof(struct sSimWatcher));
+
+    if (self == NULL) return NULL;
+
+    self->handler = handler;
+    self->parameter = parameter;
+    self->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (self->inotify < 0 || pipe(self->wakeup) != 0)
+    {
+        if (self->inotify >= 0) close(self->inotify);
+        free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void SimWatcher_destroy(SimWatcher self)
+{
+    if (self == NULL) return;
+
+    // closing the pipe wakes the thread up
+    close(self->wakeup[1]);
+
+    if (self->thread != NULL)
+        Thread_destroy(self->thread);
+
+    close(self->wakeup[0]);
+    close(self->inotify);
+
+    for (int f = 0; f < self->count; f++)
+        free(self->files[f].path);
+    free(self->files);
+    free(self);
+}
+
+int SimWatcher_add(SimWatcher self, const char* filename)
+{
+    WatchedFile* files = (WatchedFile*) realloc(self->files, (self->count + 1) * sizeof(WatchedFile));
+
+    if (files == NULL) return -1;
+    self->files = files;
+
+    WatchedFile* file = &self->files[self->count];
+    file->path = strdup(filename);
+    if (file->path == NULL) return -1;
+
+    // the directory catches replacements, the file itself writes in place (also of a file mounted on its own)
+    char* slash = strrchr(file->path, '/');
+    file->name = (slash != NULL) ? slash + 1 : file->path;
+    file->changed = false;
+
+    if (slash == NULL)
+        file->directoryWatch = inotify_add_watch(self->inotify, ".", DIRECTORY_EVENTS);
+    else if (slash == file->path)
+        file->directoryWatch = inotify_add_watch(self->inotify, "/", DIRECTORY_EVENTS);
+    else
+    {
+        *slash = 0;
+        file->directoryWatch = inotify_add_watch(self->inotify, file->path, DIRECTORY_EVENTS);
+        *slash = '/';
+    }
+
+    watchFile(self, file);
+
+    if (file->fileWatch < 0 && file->directoryWatch < 0)
+    {
+        free(file->path);
+        return -1;
+    }
+
+    return self->count++;
+}
+
+bool SimWatcher_start(SimWatcher self)
+{
+    self->thread = Thread_create(watcherThread, self, false);
+
+    if (self->thread == NULL) return false;
+
+    Thread_start(self->thread);
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef SIM_WATCHER_H_
+#define SIM_WATCHER_H_
+
+#include <stdbool.h>
+
+// watches files for changes (inotify) on a thread of its own - a file written in place or replaced (renamed over,
+// recreated) is reported once the writes have settled
+typedef struct sSimWatcher* SimWatcher;
+
+// called on the thread of the watcher with the index of the changed file (in the order of SimWatcher_add)
+typedef void (*SimWatcherHandler)(void* parameter, int file);
+
+SimWatcher SimWatcher_create(SimWatcherHandler handler, void* parameter);
+
+// stops the thread, a running handler is completed first
+void SimWatcher_destroy(SimWatcher self);
+
+// index of the file, -1 - it can not be watched
+int SimWatcher_add(SimWatcher self, const char* filename);
+
+bool SimWatcher_start(SimWatcher self);
+
+#endif /* SIM_WATCHER_H_ */
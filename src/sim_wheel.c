@@ -0,0 +1,195 @@
+#include "sim_wheel.h"
+#include <stdlib.h>
+
+#define WHEEL_LEVELS 4
+#define WHEEL_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+#define NONE (-1)
+
+struct sSimWheel
+{
+    int capacity;
+    int scheduled;
+    uint64_t now;           // last processed tick
+
+    int slots[WHEEL_LEVELS][WHEEL_SLOTS];   // list heads
+
+    // intrusive doubly linked lists, indexed by point
+    int* next;
+    int* prev;
+    int* slotOf;            // level * WHEEL_SLOTS + slot, NONE if not scheduled
+    uint64_t* due;
+};
+
+static void unlink(SimWheel self, int point)
+{
+    int s = self->slotOf[point];
+    int* head = &self->slots[s / WHEEL_SLOTS][s % WHEEL_SLOTS];
+
+    if (self->prev[point] != NONE)
+        self->next[self->prev[point]] = self->next[point];
+    else
+        *head = self->next[point];
+
+    if (self->next[point] != NONE)
+        self->prev[self->next[point]] = self->prev[point];
+
+    self->slotOf[point] = NONE;
+    self->scheduled--;
+}
+
+// places the point by its distance from now, due has to be >= now
+static void insert(SimWheel self, int point, uint64_t due)
+{
+    uint64_t delta = due - self->now;
+    int level = 0;
+
+    while (level < WHEEL_LEVELS - 1 && delta >= ((uint64_t) 1 << (WHEEL_BITS * (level + 1))))
+        level++;
+
+    // beyond the range of the wheel - park in the farthest slot, it is re-placed when cascaded
+    uint64_t slotDue = due;
+    if (delta >= ((uint64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS)))
+        slotDue = self->now + ((uint64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+
+    int slot = (int)((slotDue >> (WHEEL_BITS * level)) & WHEEL_MASK);
+    int* head = &self->slots[level][slot];
+
+    self->due[point] = due;
+    self->slotOf[point] = level * WHEEL_SLOTS + slot;
+    self->prev[point] = NONE;
+    self->next[point] = *head;
+    if (*head != NONE) self->prev[*head] = point;
+    *head = point;
+    self->scheduled++;
+}
+
+static void cascade(SimWheel self, int level, int slot)
+{
+    int point = self->slots[level][slot];
+    self->slots[level][slot] = NONE;
+
+    while (point != NONE)
+    {
+        int next = self->next[point];
+        self->scheduled--;
+        self->slotOf[point] = NONE;
+        insert(self, point, self->due[point]);
+        point = next;
+    }
+}
+
+SimWheel SimWheel_create(int capacity, uint64_t tick)
+{
+    SimWheel self = (SimWheel) calloc(1, sizeof(struct sSimWheel));
+
+    if (self == NULL) return NULL;
+
+    self->capacity = capacity;
+    self->now = tick;
+    self->next = (int*) malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    self->prev = (int*) malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    self->slotOf = (int*) malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    self->due = (uint64_t*) malloc(sizeof(uint64_t) * (capacity > 0 ? capacity : 1));
+
+    if (self->next == NULL || self->prev == NULL || self->slotOf == NULL || self->due == NULL)
+    {
+        SimWheel_destroy(self);
+        return NULL;
+    }
+
+    for (int l = 0; l < WHEEL_LEVELS; l++)
+        for (int s = 0; s < WHEEL_SLOTS; s++)
+            self->slots[l][s] = NONE;
+
+    for (int i = 0; i < capacity; i++)
+    {
+        self->slotOf[i] = NONE;
+        self->due[i] = tick;
+    }
+
+    return self;
+}
+
+void SimWheel_destroy(SimWheel self)
+{
+    if (self == NULL) return;
+
+    free(self->next);
+    free(self->prev);
+    free(self->slotOf);
+    free(self->due);
+    free(self);
+}
+
+void SimWheel_schedule(SimWheel self, int point, uint64_t dueTick)
+{
+    if (point < 0 || point >= self->capacity) return;
+
+    if (self->slotOf[point] != NONE)
+        unlink(self, point);
+
+    // the slot of the current tick was already processed
+    if (dueTick <= self->now)
+        dueTick = self->now + 1;
+
+    insert(self, point, dueTick);
+}
+
+void SimWheel_cancel(SimWheel self, int point)
+{
+    if (point < 0 || point >= self->capacity) return;
+
+    if (self->slotOf[point] != NONE)
+        unlink(self, point);
+}
+
+int SimWheel_advance(SimWheel self, uint64_t tick, int* due)
+{
+    int count = 0;
+
+    while (self->now < tick)
+    {
+        if (self->scheduled == 0)
+        {
+            self->now = tick;
+            break;
+        }
+
+        uint64_t now = ++self->now;
+
+        // refill the lower levels when they wrap, highest level first
+        for (int level = WHEEL_LEVELS - 1; level > 0; level--)
+        {
+            if ((now & (((uint64_t) 1 << (WHEEL_BITS * level)) - 1)) == 0)
+                cascade(self, level, (int)((now >> (WHEEL_BITS * level)) & WHEEL_MASK));
+        }
+
+        int slot = (int)(now & WHEEL_MASK);
+        int point = self->slots[0][slot];
+        self->slots[0][slot] = NONE;
+
+        while (point != NONE)
+        {
+            int next = self->next[point];
+            self->slotOf[point] = NONE;
+            self->scheduled--;
+            due[count++] = point;
+            point = next;
+        }
+    }
+
+    return count;
+}
+
+uint64_t SimWheel_getDue(SimWheel self, int point)
+{
+    return self->due[point];
+}
+
+int SimWheel_getScheduledCount(SimWheel self)
+{
+    return self->scheduled;
+}
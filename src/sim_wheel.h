@@ -0,0 +1,26 @@
+#ifndef SIM_WHEEL_H_
+#define SIM_WHEEL_H_
+
+#include <stdint.h>
+
+// hierarchical timing wheel (4 levels x 256 slots) over data point indices;
+// the cost of advancing is proportional to the number of due points, not to the number of points
+typedef struct sSimWheel* SimWheel;
+
+SimWheel SimWheel_create(int capacity, uint64_t tick);
+void SimWheel_destroy(SimWheel self);
+
+// (re)schedules a point, due ticks in the past fire on the next tick
+void SimWheel_schedule(SimWheel self, int point, uint64_t dueTick);
+void SimWheel_cancel(SimWheel self, int point);
+
+// advances the wheel to tick, stores the points that became due (each at most once) into due and returns their count;
+// due has to hold capacity entries, fired points are not rescheduled automatically
+int SimWheel_advance(SimWheel self, uint64_t tick, int* due);
+
+// tick the point was (last) scheduled for
+uint64_t SimWheel_getDue(SimWheel self, int point);
+
+int SimWheel_getScheduledCount(SimWheel self);
+
+#endif /* SIM_WHEEL_H_ */
@@ -0,0 +1,102 @@
+#include "sim_workers.h"
+#include "hal_thread.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef struct
+{
+    SimWorkers pool;
+    int index;
+    Thread thread;
+    Semaphore start;
+} SimWorker;
+
+struct sSimWorkers
+{
+    int count;
+    SimWorkerFunction function;
+    void* parameter;
+
+    bool running;
+    Semaphore done;
+    SimWorker* workers;
+};
+
+static void* workerThread(void* parameter)
+{
+    SimWorker* worker = (SimWorker*) parameter;
+    SimWorkers pool = worker->pool;
+
+    while (true)
+    {
+        Semaphore_wait(worker->start);
+
+        if (!pool->running) break;
+
+        pool->function(pool->parameter, worker->index);
+
+        Semaphore_post(pool->done);
+    }
+
+    return NULL;
+}
+
+SimWorkers SimWorkers_create(int count, SimWorkerFunction function, void* parameter)
+{
+    SimWorkers self = (SimWorkers) calloc(1, sizeof(struct sSimWorkers));
+
+    if (self == NULL) return NULL;
+
+    self->count = (count > 0) ? count : 1;
+    self->function = function;
+    self->parameter = parameter;
+    self->running = true;
+    self->done = Semaphore_create(0);
+    self->workers = (SimWorker*) calloc(self->count, sizeof(SimWorker));
+
+    for (int w = 1; w < self->count; w++)
+    {
+        SimWorker* worker = &self->workers[w];
+        worker->pool = self;
+        worker->index = w;
+        worker->start = Semaphore_create(0);
+        worker->thread = Thread_create(workerThread, worker, false);
+        Thread_start(worker->thread);
+    }
+
+    return self;
+}
+
+void SimWorkers_destroy(SimWorkers self)
+{
+    if (self == NULL) return;
+
+    self->running = false;
+
+    for (int w = 1; w < self->count; w++)
+    {
+        Semaphore_post(self->workers[w].start);
+        Thread_destroy(self->workers[w].thread);
+        Semaphore_destroy(self->workers[w].start);
+    }
+
+    Semaphore_destroy(self->done);
+    free(self->workers);
+    free(self);
+}
+
+void SimWorkers_run(SimWorkers self)
+{
+    for (int w = 1; w < self->count; w++)
+        Semaphore_post(self->workers[w].start);
+
+    self->function(self->parameter, 0);
+
+    for (int w = 1; w < self->count; w++)
+        Semaphore_wait(self->done);
+}
+
+int SimWorkers_getCount(SimWorkers self)
+{
+    return self->count;
+}
@@ -0,0 +1,21 @@
+#ifndef SIM_WORKERS_H_
+#define SIM_WORKERS_H_
+
+#include <stdint.h>
+
+// fixed pool of simulation workers running one job per tick in parallel
+typedef struct sSimWorkers* SimWorkers;
+
+// job of a worker, called with the index of the worker [0, count)
+typedef void (*SimWorkerFunction)(void* parameter, int worker);
+
+// count - 1 threads are created, worker 0 runs on the thread calling SimWorkers_run
+SimWorkers SimWorkers_create(int count, SimWorkerFunction function, void* parameter);
+void SimWorkers_destroy(SimWorkers self);
+
+// runs the job on all workers and returns when every worker has finished
+void SimWorkers_run(SimWorkers self);
+
+int SimWorkers_getCount(SimWorkers self);
+
+#endif /* SIM_WORKERS_H_ */